@@ -2,6 +2,9 @@
 
 #include <common/aglShaderEnum.h>
 
+#include <string>
+#include <unordered_map>
+
 #if RIO_IS_CAFE || RIO_IS_WIN
 #include <cafe/gx2/gx2Shaders.h>
 #endif // RIO_IS_CAFE || RIO_IS_WIN
@@ -19,7 +22,11 @@ public:
     virtual ShaderMode getShaderMode() const { return cShaderMode_Invalid; }
     virtual u32 getRingItemSize() const { return 0; }
 
-    u32 setUp(bool compile_source, bool) const;
+    // If p_source is given, it is used as the compile source instead of recalculating it.
+    u32 setUp(bool compile_source, bool, const std::string* p_source = nullptr) const;
+
+    // Calculates the compile source with variation_map substituted for the variation macros, without modifying the compile info.
+    void calcCompileSource(std::string* p_buffer, const std::unordered_map<std::string, const std::string>& variation_map) const;
 
     void* getBinary() { return const_cast<void*>(mBinary); }
     const void* getBinary() const { return mBinary; }
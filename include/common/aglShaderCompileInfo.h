@@ -58,6 +58,14 @@ public:
 
     void calcCompileSource(ShaderType type, std::string* p_buffer, Target target, bool) const;
 
+    // Same as calcCompileSource(), but substitutes variation_map instead of the pushed variations and leaves the raw text untouched.
+    // Reads only the source text and macros of the compile info and variation_map, never mVariationMap,
+    // so worker threads may call it while the main thread pushes variations (the only state it modifies meanwhile).
+    void calcCompileSourceForVariation(ShaderType type, std::string* p_buffer, Target target, const std::unordered_map<std::string, const std::string>& variation_map) const;
+
+private:
+    void calcCompileSource_(ShaderType type, std::string* p_buffer, Target target, const std::unordered_map<std::string, const std::string>& variation_map) const;
+
 private:
     const std::string* mSourceText;
     std::string* mRawText;
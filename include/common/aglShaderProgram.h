@@ -7,6 +7,8 @@
 #include <common/aglShaderLocation.h>
 #include <container/Buffer.h>
 #include <container/SafeArray.h>
+#include <detail/aglBoundStateCache.h>
+#include <detail/aglShaderSymbolTable.h>
 #include <misc/rio_BitFlag.h>
 #include <misc/Namable.h>
 
@@ -151,29 +153,43 @@ public:
         return mGeometryShader.getBinary();
 #endif // RIO_IS_WIN
     }
+
+    // Name lookup tables of the binaries above, built the first time they are needed
+    const detail::ShaderSymbolTable* getVertexShaderSymbolTable() const;
+    const detail::ShaderSymbolTable* getFragmentShaderSymbolTable() const;
+    const detail::ShaderSymbolTable* getGeometryShaderSymbolTable() const;
 #endif // RIO_IS_CAFE || RIO_IS_WIN
 
 #if RIO_IS_WIN
+    // The caller may bind the program or overwrite the push constants, so both are set again on the next activation
     rio::Shader* getShaderRIO()
     {
         updateCompile();
+        mIsPushUploaded = false;
+        detail::BoundStateCache::invalidateShaderProgram();
         return mShader.isLoaded() ? &mShader : nullptr;
     }
 
     const rio::Shader* getShaderRIO() const
     {
         updateCompile();
+        mIsPushUploaded = false;
+        detail::BoundStateCache::invalidateShaderProgram();
         return mShader.isLoaded() ? &mShader : nullptr;
     }
 
     void setUseBinaryProgram(bool enable)
     {
         mFlag.change(16, enable);
+        mIsPushUploaded = false;
 
         if (getVariation_())
         {
             for (Buffer<ShaderProgram>::iterator it = getVariation_()->mProgram.begin(), it_end = getVariation_()->mProgram.end(); it != it_end; ++it)
+            {
                 it->mFlag.change(16, enable);
+                it->mIsPushUploaded = false;
+            }
         }
     }
 
@@ -204,6 +220,9 @@ public:
     void setSamplerLocationName(s32 index, const char* name);
 
     u32 setUpAllVariation(); // I don't know the actual return type
+    // (Custom) Sets up all variations of several programs at once. The compile sources of every variation
+    // are generated on worker threads beforehand, and only the compilation itself happens on the calling thread.
+    static u32 setUpAllVariation(ShaderProgram* const* programs, s32 num);
     void reserveSetUpAllVariation();
 
     s32 getVariationNum() const;
@@ -261,11 +280,30 @@ public:
     void destroySamplerLocation();
 
 private:
-    u32 validate_() const;
-    u32 forceValidate_() const;
+    struct CompileSource
+    {
+        bool is_valid;
+        std::string text[cShaderType_Num];
+    };
+
+    u32 validate_(const CompileSource* p_source = nullptr) const;
+    u32 forceValidate_(const CompileSource* p_source = nullptr) const;
+
+    void prepareValidate_(CompileSource* p_source) const;
+    bool isCompileSourceRequired_() const;
+    void calcCompileSource_(CompileSource* p_source) const;
 
     void setUpForVariation_() const;
 
+#if RIO_IS_WIN
+    // Custom
+    void loadShaderRIO_(const std::string& vertex_src, const std::string& fragment_src) const;
+    bool loadShaderRIOFromCache_(const std::string& key) const;
+    void saveShaderRIOToCache_(const std::string& key) const;
+    void updatePushLocation_() const;
+    void bindCfile_() const;
+#endif // RIO_IS_WIN
+
     void setShaderGX2_() const;
 
     class SharedData;
@@ -355,11 +393,30 @@ private:
     GeometryShader mGeometryShader;
     SharedData* mpSharedData;
 
+#if RIO_IS_CAFE || RIO_IS_WIN
+    // Custom
+    mutable detail::ShaderSymbolTable mSymbolTable[cShaderType_Num];
+#endif // RIO_IS_CAFE || RIO_IS_WIN
+
 #if RIO_IS_WIN
     // Custom
     mutable rio::Shader mShader;
     mutable s32 mVsCfileBlockIdx;
     mutable s32 mPsCfileBlockIdx;
+
+    // Locations of the push constants set by setShaderGX2_(), resolved once per link
+    struct PushLocation
+    {
+        u32 ps_alpha_func;
+        u32 ps_item_id;
+        u32 ps_is_selected;
+        u32 ps_needs_premultiply;
+        u32 vs_pos_mul_add;
+        u32 vs_z_space_mul;
+        u32 vs_point_size;
+    };
+    mutable PushLocation mPushLocation;
+    mutable bool mIsPushUploaded;   // The program holds the values set by setShaderGX2_()
 #endif // RIO_IS_WIN
 };
 //static_assert(sizeof(ShaderProgram) == 0x60, "agl::ShaderProgram size mismatch");
@@ -71,6 +71,7 @@ class ShaderProgramArchive
         ShaderSource();
 
         void initialize(ShaderProgramArchive* archive, s32 index, ResShaderSource res, bool is_used);
+        void analyzeInclude();
         void expand();
 
         const char* getName() const
@@ -79,6 +80,13 @@ class ShaderProgramArchive
         }
 
     private:
+        struct Include
+        {
+            std::string::size_type mBegin;  // Position of the '#'
+            std::string::size_type mEnd;    // Position following the closing '"'
+            s32 mSourceIndex;
+        };
+
         s32 mIndex;
         rio::BitFlag32 mFlag;
         ShaderProgramArchive* mpArchive;
@@ -88,6 +96,10 @@ class ShaderProgramArchive
         std::string mOriginalText;
         std::string mRawText;
 
+        // Custom
+        std::vector<Include> mInclude;  // #include directives of mOriginalText, in order
+        std::vector<s32> mDependent;    // Indices of the sources including this one
+
         friend class ShaderProgramArchive;
     };
   //static_assert(sizeof(ShaderSource) == 0x30, "agl::ShaderProgramArchive::ShaderSource size mismatch");
@@ -152,11 +164,17 @@ public:
 
     void updateCompileInfo();
 
+    // (Custom) Replaces the text of the source with the given name, e.g. to hot reload it.
+    // The next updateCompileInfo() only expands again this source and the ones including it.
+    bool updateSourceText(const char* name, const std::string& text);
+
 private:
     void destroyResFile_();
     void setResShaderArchive_(ResShaderArchive res_archive);
     bool setUp_(bool);
 
+    void updateSourceDependent_();
+
 private:
     ResBinaryShaderArchive mResBinary;
     ResShaderArchive mResText;
@@ -169,7 +187,7 @@ private:
 
     // Custom
     std::vector<ShaderSource> mSourceVec;
-    std::unordered_map<std::string, const std::string> mSourceMap;
+    std::unordered_map<std::string, s32> mSourceIndexMap;
 
 #if RIO_IS_CAFE
     void* mpDLBuf;
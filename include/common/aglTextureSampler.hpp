@@ -1,5 +1,7 @@
 #pragma once
 
+#include <detail/aglBoundStateCache.h>
+
 #if RIO_IS_WIN
 #include <gpu/win/rio_Texture2DUtilWin.h>
 #endif // RIO_IS_WIN
@@ -51,24 +53,33 @@ TextureSampler::applyTextureData(const TextureData& texture_data)
 
 #endif
     }
+
+    // Also binds the texture on Windows
+    detail::BoundStateCache::invalidateTextureSampler();
 }
 
 inline void
 TextureSampler::setWrapX(TextureWrapType wrap_x)
 {
     mSamplerInner.setWrapX((rio::TexWrapMode)wrap_x);
+
+    detail::BoundStateCache::invalidateTextureSampler();
 }
 
 inline void
 TextureSampler::setWrapY(TextureWrapType wrap_y)
 {
     mSamplerInner.setWrapY((rio::TexWrapMode)wrap_y);
+
+    detail::BoundStateCache::invalidateTextureSampler();
 }
 
 inline void
 TextureSampler::setWrapZ(TextureWrapType wrap_z)
 {
     mSamplerInner.setWrapZ((rio::TexWrapMode)wrap_z);
+
+    detail::BoundStateCache::invalidateTextureSampler();
 }
 
 inline void
@@ -83,24 +94,32 @@ TextureSampler::setWrap(
         (rio::TexWrapMode)wrap_y,
         (rio::TexWrapMode)wrap_z
     );
+
+    detail::BoundStateCache::invalidateTextureSampler();
 }
 
 inline void
 TextureSampler::setFilterMag(TextureFilterType filter_mag)
 {
     mSamplerInner.setMagFilter((rio::TexXYFilterMode)filter_mag);
+
+    detail::BoundStateCache::invalidateTextureSampler();
 }
 
 inline void
 TextureSampler::setFilterMin(TextureFilterType filter_min)
 {
     mSamplerInner.setMinFilter((rio::TexXYFilterMode)filter_min);
+
+    detail::BoundStateCache::invalidateTextureSampler();
 }
 
 inline void
 TextureSampler::setFilterMip(TextureMipFilterType filter_mip)
 {
     mSamplerInner.setMipFilter((rio::TexMipFilterMode)filter_mip);
+
+    detail::BoundStateCache::invalidateTextureSampler();
 }
 
 inline void
@@ -113,24 +132,32 @@ TextureSampler::setFilter(
     mSamplerInner.setMagFilter((rio::TexXYFilterMode )filter_mag);
     mSamplerInner.setMinFilter((rio::TexXYFilterMode )filter_min);
     mSamplerInner.setMipFilter((rio::TexMipFilterMode)filter_mip);
+
+    detail::BoundStateCache::invalidateTextureSampler();
 }
 
 inline void
 TextureSampler::setMaxAnisoRatio(TextureAnisoRatio max_aniso)
 {
     mSamplerInner.setMaxAnisoRatio((rio::TexAnisoRatio)max_aniso);
+
+    detail::BoundStateCache::invalidateTextureSampler();
 }
 
 inline void
 TextureSampler::setMipParam(f32 lod_min, f32 lod_max, f32 lod_bias)
 {
     mSamplerInner.setLOD(lod_min, lod_max, lod_bias);
+
+    detail::BoundStateCache::invalidateTextureSampler();
 }
 
 inline void
 TextureSampler::setBorderColor(f32 r, f32 g, f32 b, f32 a)
 {
     mSamplerInner.setBorderColor(r, g, b, a);
+
+    detail::BoundStateCache::invalidateTextureSampler();
 }
 
 inline void
@@ -143,12 +170,16 @@ inline void
 TextureSampler::setDepthCompareEnable(bool enable)
 {
     mSamplerInner.setDepthCompareEnable(enable);
+
+    detail::BoundStateCache::invalidateTextureSampler();
 }
 
 inline void
 TextureSampler::setDepthCompareFunc(rio::Graphics::CompareFunc func)
 {
     mSamplerInner.setDepthCompareFunc(func);
+
+    detail::BoundStateCache::invalidateTextureSampler();
 }
 
 }
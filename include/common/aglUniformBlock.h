@@ -4,6 +4,8 @@
 #include <math/rio_Vector.h>
 #include <misc/rio_BitFlag.h>
 
+#include <algorithm>
+
 #if RIO_IS_WIN
 #include <gpu/rio_UniformBlock.h>
 #endif // RIO_IS_WIN
@@ -32,6 +34,15 @@ public:
     static const u32 cUniformBlockAlignment = 0x100;
     static const u32 cCPUCacheLineSize = 0x20;
 
+    // Totals of all flushes of the blocks' own buffers since the last resetStatistics()
+    struct Statistics
+    {
+        u32 flush_num;
+        u32 skip_num;       // Flushes with nothing written since the previous one
+        u32 declared_size;  // Sum of the sizes of the flushed blocks
+        u32 upload_size;    // Sum of the bytes actually flushed
+    };
+
 public:
     enum Type
     {
@@ -71,12 +82,21 @@ public:
     void declare(const UniformBlock& block);
     void create();
     void destroy();
+    u32 getBlockSize() const { return mBlockSize; }
+
     void dcbz() const;
     void flush(void* p_memory, bool invalidate_gpu) const;
     void flush(bool invalidate_gpu) const { flush(mCurrentBuffer, invalidate_gpu); }
     void flushNoSync(void* p_memory, bool invalidate_gpu) const;
     void flushNoSync(bool invalidate_gpu) const { flushNoSync(mCurrentBuffer, invalidate_gpu); }
 
+    // Only the range written through the setters since the last flush is flushed, and nothing if there is none.
+    // This applies to the block's own buffer; other memory passed to flush() is always flushed as a whole.
+    bool isDirty() const { return mDirtyBegin < mDirtyEnd; }
+
+    static const Statistics& getStatistics() { return sStatistics; }
+    static void resetStatistics();
+
     bool setUniform(const void* p_data, const UniformBlockLocation& location, u32 offset, size_t size) const;
     bool setUniform(const UniformBlockLocation& location) const;
 
@@ -112,6 +132,25 @@ public:
 
 private:
     void setData_(void* p_memory, s32 index, const void* p_data, s32 array_index, s32 array_num) const;
+    void flush_(void* p_memory, bool invalidate_gpu, bool sync) const;
+
+    void setDirty_(u32 begin, u32 end) const
+    {
+        mDirtyBegin = std::min(mDirtyBegin, begin);
+        mDirtyEnd = std::max(mDirtyEnd, std::min(end, mBlockSize));
+    }
+
+    void setDirtyAll_() const
+    {
+        mDirtyBegin = 0;
+        mDirtyEnd = mBlockSize;
+    }
+
+    void clearDirty_() const
+    {
+        mDirtyBegin = u32(-1);
+        mDirtyEnd = 0;
+    }
 
 private:
     enum Flags
@@ -128,6 +167,10 @@ private:
 #endif // RIO_IS_WIN
     u32 mBlockSize;
     rio::BitFlag8 mFlag;
+    mutable u32 mDirtyBegin;    // Byte range of mCurrentBuffer written since the last flush
+    mutable u32 mDirtyEnd;      // ^^
+
+    static Statistics sStatistics;
 };
 //static_assert(sizeof(UniformBlock) == 0x14, "agl::UniformBlock size mismatch");
 
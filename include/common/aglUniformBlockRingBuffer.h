@@ -0,0 +1,84 @@
+#pragma once
+
+#include <common/aglUniformBlock.h>
+
+namespace agl {
+
+// Frame-scoped linear allocator for uniform block data that is rewritten every draw.
+// The buffer is split into one region per frame in flight; alloc() bumps a pointer in the current region,
+// and the region is not written again until frame_num frames later, so the GPU must never be more than
+// frame_num - 1 frames behind the CPU.
+//
+// Usage, with a UniformBlock that was declared but not created:
+//   void* p_memory = ring.alloc(block);
+//   block.setVector4f(p_memory, 0, param);
+//   ring.flush(p_memory, block.getBlockSize());
+//   ring.setUniform(p_memory, block.getBlockSize(), location);
+class UniformBlockRingBuffer
+{
+public:
+    struct Statistics
+    {
+        u32 alloc_num;          // In the current frame
+        u32 alloc_failed_num;   // ^^
+        u32 peak_used_size;     // Of all frames since create()
+    };
+
+public:
+    UniformBlockRingBuffer();
+    virtual ~UniformBlockRingBuffer();
+
+    UniformBlockRingBuffer(const UniformBlockRingBuffer&) = delete;
+    UniformBlockRingBuffer(UniformBlockRingBuffer&&) = delete;
+    UniformBlockRingBuffer& operator=(const UniformBlockRingBuffer&) = delete;
+    UniformBlockRingBuffer& operator=(UniformBlockRingBuffer&&) = delete;
+
+    bool create(u32 frame_size, s32 frame_num);
+    void destroy();
+
+    bool isCreated() const { return mpBuffer != nullptr; }
+
+    u32 getFrameSize() const { return mFrameSize; }
+    s32 getFrameNum() const { return mFrameNum; }
+    s32 getFrameIndex() const { return mFrameIndex; }
+    u32 getUsedSize() const { return mUsedSize; }
+
+    // Moves to the region of the next frame and discards the allocations made in it frame_num frames ago
+    void beginFrame();
+
+    // Returns nullptr if the current frame's region is full
+    void* alloc(u32 size);
+    void* alloc(const UniformBlock& block) { return alloc(block.getBlockSize()); }
+
+    // Makes data written to an allocation visible to the GPU
+    void flush(const void* p_memory, u32 size, bool invalidate_gpu = true) const;
+
+    bool setUniform(const void* p_memory, u32 size, const UniformBlockLocation& location) const;
+
+    const Statistics& getStatistics() const { return mStatistics; }
+
+private:
+    bool isInBuffer_(const void* p_memory) const
+    {
+        return mpBuffer <= p_memory && p_memory < mpBuffer + mFrameSize * mFrameNum;
+    }
+
+    u32 getOffset_(const void* p_memory) const
+    {
+        return static_cast<const u8*>(p_memory) - mpBuffer;
+    }
+
+private:
+    u8* mpBuffer;
+    u32 mFrameSize;
+    s32 mFrameNum;
+    s32 mFrameIndex;
+    u32 mUsedSize;      // In the current frame's region
+    u32 mAlignment;
+#if RIO_IS_WIN
+    u32 mHandle;
+#endif // RIO_IS_WIN
+    Statistics mStatistics;
+};
+
+}
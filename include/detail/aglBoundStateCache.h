@@ -0,0 +1,72 @@
+#pragma once
+
+#include <misc/rio_Types.h>
+
+namespace agl {
+
+class ShaderProgram;
+class TextureSampler;
+class VertexAttribute;
+
+namespace detail {
+
+// Remembers the shader program, vertex attribute and texture samplers last activated through agl,
+// so that activating them again without anything else bound in between is skipped.
+// Disabled by default. While enabled, state bound without going through agl (e.g. directly through rio or GX2)
+// must be followed by invalidate(), which driver::GX2Resource::restoreContextState() also does.
+// Only the bind of the objects themselves is skipped: state shared between them, such as the uniform buffer
+// binding points of the CFILE blocks on Windows, is still applied on every activation.
+class BoundStateCache
+{
+public:
+    static const s32 cTextureSlotMax = 16;
+
+    struct Counter
+    {
+        u32 program_bind;
+        u32 program_elided;
+        u32 vertex_attribute_bind;
+        u32 vertex_attribute_elided;
+        u32 sampler_bind;
+        u32 sampler_elided;
+    };
+
+public:
+    static void setEnable(bool enable);
+    static bool isEnable() { return sEnable; }
+
+    // Forgets all bound state
+    static void invalidate();
+
+    static const Counter& getCounter() { return sCounter; }
+    static void resetCounter();
+
+    // Return true if the object has to be bound, false if it is known to be bound already.
+    static bool bindShaderProgram(const ShaderProgram* p_program);
+    static bool bindVertexAttribute(const VertexAttribute* p_attribute);
+    static bool bindTextureSampler(const TextureSampler* p_sampler, s32 vs, s32 fs, s32 gs, s32 slot);
+
+    // Called when the objects are modified or destroyed, or when they bind other state internally.
+    // Programs also own the values of the sampler uniforms, so invalidating them invalidates the samplers too.
+    static void invalidateShaderProgram();
+    static void invalidateVertexAttribute();
+    static void invalidateTextureSampler();
+
+private:
+    struct TextureSlot
+    {
+        const TextureSampler*   p_sampler;
+        const ShaderProgram*    p_program;
+        s32                     vs;
+        s32                     fs;
+        s32                     gs;
+    };
+
+    static bool                     sEnable;
+    static const ShaderProgram*     spProgram;
+    static const VertexAttribute*   spVertexAttribute;
+    static TextureSlot              sTextureSlot[cTextureSlotMax];
+    static Counter                  sCounter;
+};
+
+} }
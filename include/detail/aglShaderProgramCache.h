@@ -0,0 +1,49 @@
+#pragma once
+
+#include <common/aglShaderCompileInfo.h>
+
+#include <string>
+
+namespace agl { namespace detail {
+
+// On-disk cache of linked program binaries, keyed by the final compile source
+class ShaderProgramCache
+{
+public:
+    // Native path of the cache directory. Caching is disabled while empty.
+    static std::string sDirectory;
+
+public:
+    static bool isEnabled()
+    {
+        return !sDirectory.empty();
+    }
+
+    static std::string calcKey(ShaderCompileInfo::Target target, const std::string& vertex_src, const std::string& fragment_src);
+
+    // Returns false if there is no entry or it is corrupted, in which case the program must be compiled normally.
+    static bool read(const std::string& key, u32* p_format, std::string* p_binary);
+    static bool write(const std::string& key, u32 format, const std::string& binary);
+
+    // Called when an entry could not be used, e.g. because it was created by a different driver
+    static void remove(const std::string& key);
+
+private:
+    static std::string getPath_(const std::string& key);
+
+private:
+    struct Header
+    {
+        u32 mMagic;
+        u32 mVersion;
+        u32 mFormat;
+        u32 mSize;
+        u32 mHash;  // CRC32 of the binary
+    };
+    static_assert(sizeof(Header) == 0x14, "agl::detail::ShaderProgramCache::Header size mismatch");
+
+    static const u32 cMagic = 0x43504741; // "AGPC"
+    static const u32 cVersion = 1;
+};
+
+} }
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <misc/rio_Types.h>
+
+#include <vector>
+
+#if RIO_IS_CAFE || RIO_IS_WIN
+#include <cafe/gx2/gx2Shaders.h>
+#endif // RIO_IS_CAFE || RIO_IS_WIN
+
+namespace agl { namespace detail {
+
+#if RIO_IS_CAFE || RIO_IS_WIN
+
+// Name to index tables of the variables of a GX2 shader binary, so that location searches don't scan them with strcmp
+class ShaderSymbolTable
+{
+public:
+    enum Kind
+    {
+        cKind_UniformVar = 0,
+        cKind_UniformBlock,
+        cKind_SamplerVar,
+        cKind_AttribVar,    // Vertex shader only
+        cKind_Num
+    };
+
+public:
+    ShaderSymbolTable();
+
+    void build(const GX2VertexShader* p_shader);
+    void build(const GX2PixelShader* p_shader);
+    void build(const GX2GeometryShader* p_shader);
+
+    void clear();
+
+    bool isBuilt(const void* p_shader) const
+    {
+        return mpShader != nullptr && mpShader == p_shader;
+    }
+
+    // Returns the index of the variable in the array of its kind, or -1 if there is none with that name.
+    s32 search(Kind kind, const char* name) const;
+
+private:
+    struct Entry
+    {
+        u32         hash;
+        u32         index;
+        const char* name;   // Points into the binary
+    };
+
+    template <typename T>
+    void build_(Kind kind, const T* vars, u32 num);
+
+    static u32 calcHash_(const char* name);
+
+private:
+    std::vector<Entry>  mEntry[cKind_Num];  // Sorted by hash
+    const void*         mpShader;
+};
+
+#endif // RIO_IS_CAFE || RIO_IS_WIN
+
+} }
@@ -11,6 +11,8 @@ class ShaderTextUtil
 {
 public:
     static void replaceMacro(std::string* p_text, const std::unordered_map<std::string, const std::string>& macro_map);
+    // Same result as replacing with macro_map and then with variation_map, in a single pass over the text
+    static void replaceMacro(std::string* p_text, const std::unordered_map<std::string, const std::string>& macro_map, const std::unordered_map<std::string, const std::string>& variation_map);
     static void createRawText(std::string* p_text, const std::unordered_map<std::string, const std::string>& source_map);
 };
 
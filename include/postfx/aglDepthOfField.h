@@ -60,7 +60,7 @@ class DepthOfField : public utl::IParameterIO
 
     struct TempVignetting : utl::IParameterObj
     {
-        TempVignetting(DepthOfField* p_dof, const char* param_name);
+        TempVignetting(DepthOfField* p_dof, const utl::ParameterName& param_name);
 
         utl::Parameter<s32> mType;
         utl::Parameter<rio::Vector2f> mRange;
@@ -1,12 +1,72 @@
 #pragma once
 
+#include <codec/HashCRC32.h>
 #include <container/rio_LinkList.h>
 
+#include <type_traits>
+
 namespace agl { namespace utl {
 
 class IParameterObj;
 class ResParameter;
 
+// Name of a parameter, object or list together with its hash.
+// String literals are hashed at compile time; other strings, including writable char arrays, are hashed at runtime.
+class ParameterName
+{
+public:
+    // Only for string literals and constexpr arrays, as the hash is computed at compile time.
+    // Other const char arrays (e.g. static const char cName[] = "...", or a const char (&)[N] forwarded by a template)
+    // also select this constructor and fail to compile; pass them through runtime() instead.
+    template <u32 N>
+    consteval ParameterName(const char (&name)[N])
+        : mName(name)
+        , mHash(HashCRC32::calcStringHash(name, calcLength_(name, N)))
+    {
+    }
+
+    // Names built at runtime into a buffer, e.g. with snprintf(); preferred over the one above for non-const arrays
+    template <u32 N>
+    ParameterName(char (&name)[N])
+        : mName(name)
+        , mHash(calcHash_(name))
+    {
+    }
+
+    // Only chosen for pointers, so that literals always take the consteval constructor
+    template <typename T, typename std::enable_if<std::is_same<T, char>::value, int>::type = 0>
+    ParameterName(const T* const& name)
+        : mName(name)
+        , mHash(calcHash_(name))
+    {
+    }
+
+    // Hashes name at runtime, whatever it points to
+    static ParameterName runtime(const char* name)
+    {
+        return ParameterName(name);
+    }
+
+    constexpr const char* getName() const { return mName; }
+    constexpr u32 getHash() const { return mHash; }
+
+private:
+    static constexpr u32 calcLength_(const char* name, u32 size)
+    {
+        u32 len = 0;
+        while (len < size && name[len] != '\0')
+            len++;
+
+        return len;
+    }
+
+    static u32 calcHash_(const char* name);
+
+private:
+    const char* mName;
+    u32 mHash;
+};
+
 class ParameterBase
 {
 public:
@@ -55,7 +115,7 @@ protected:
     virtual void postApplyResource_(const void*, size_t) { }
 
 public:
-    void initializeListNode(const char* name, const char* label, const char* meta, IParameterObj* p_obj);
+    void initializeListNode(const ParameterName& name, const char* label, const char* meta, IParameterObj* p_obj);
 
     u32 getNameHash() const { return mHash; }
     static u32 calcHash(const char* s);
@@ -65,6 +125,7 @@ protected:
     rio::LinkListNode mListNode;
 
     friend class IParameterObj;
+    friend class ParameterApplyPlan;
 };
 static_assert(sizeof(ParameterBase) == 0x10, "agl::utl::ParameterBase size mismatch");
 
@@ -72,7 +133,7 @@ template <typename T>
 class Parameter : public ParameterBase
 {
 public:
-    Parameter(const T& value, const char* name, const char* label, IParameterObj* p_obj)
+    Parameter(const T& value, const ParameterName& name, const char* label, IParameterObj* p_obj)
         : ParameterBase()
     {
         initializeListNode(name, label, "", p_obj);
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <utility/aglResParameter.h>
+
+#include <vector>
+
+namespace agl { namespace utl {
+
+class IParameterList;
+class IParameterObj;
+class ParameterBase;
+
+// Flattened result of matching a parameter archive against a parameter tree.
+// Applying it again only copies values, calls the read callbacks and skips objects whose preRead_() fails,
+// without name matching, list walks or per-parameter type dispatch.
+// The plan keeps pointers into the archive, so it must be rebuilt when the archive is modified or released.
+// Changes to the tree are detected through IParameterList::getTreeRevision() of the root.
+class ParameterApplyPlan
+{
+public:
+    ParameterApplyPlan();
+
+    void build(IParameterList* p_root, ResParameterArchive arc);
+    void clear();
+
+    bool isValid(const IParameterList* p_root, ResParameterArchive arc) const;
+
+    void apply() const;
+
+private:
+    enum OpType
+    {
+        cOp_BeginList,
+        cOp_EndList,
+        cOp_BeginObj,
+        cOp_EndObj,
+        cOp_Copy,
+        cOp_CopyBool,
+        cOp_NotAppliable
+    };
+
+    struct Op
+    {
+        OpType                  type;
+        u32                     value;      // Begin*: index of the op following the matching End*, Copy*: size of the value
+        void*                   p_node;     // IParameterList, IParameterObj or ParameterBase
+        void*                   p_dst;      // Copy*: value of the parameter, NotAppliable: parent list
+        const ResParameterData* p_res;      // Copy*, NotAppliable
+    };
+
+    void buildList_(IParameterList* p_list, ResParameterList res);
+    void buildObj_(IParameterObj* p_obj, ResParameterObj res, IParameterList* p_list);
+
+private:
+    std::vector<Op>         mOp;
+    const IParameterList*   mpRoot;
+    const void*             mpArchive;
+    u32                     mArchiveSize;
+    u32                     mTreeRevision;  // Of mpRoot when the plan was built
+};
+
+} }
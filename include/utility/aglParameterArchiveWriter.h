@@ -0,0 +1,63 @@
+#pragma once
+
+#include <misc/rio_Types.h>
+
+#include <string>
+#include <vector>
+
+namespace agl { namespace utl {
+
+class IParameterList;
+class IParameterObj;
+class ParameterBase;
+
+// Serializes a parameter tree into the layout read by ResParameterArchive.
+// The constructor calls preWrite_() of every list and object once and leaves out the nodes for which it returns false,
+// together with their children, so the size of the archive is known before writing and the tree is written in a single pass.
+// postWrite_() of the written nodes is called once, after write() or on destruction if the archive was never written.
+class ParameterArchiveWriter
+{
+public:
+    ParameterArchiveWriter(const IParameterList* p_root, const char* type, u32 type_version);
+    ~ParameterArchiveWriter();
+
+    ParameterArchiveWriter(const ParameterArchiveWriter&) = delete;
+    ParameterArchiveWriter& operator=(const ParameterArchiveWriter&) = delete;
+
+    u32 getArchiveSize() const { return mArchiveSize; }
+
+    // Writes the archive to dst, which must be at least getArchiveSize() bytes large and 4-byte aligned.
+    // is_le selects the byte order of the archive.
+    // Returns the size of the archive, or 0 on failure.
+    u32 write(void* dst, u32 dst_size, bool is_le);
+
+private:
+    // List or object whose preWrite_() returned true
+    struct Node
+    {
+        const IParameterList*   p_list;
+        const IParameterObj*    p_obj;
+    };
+
+    u32 prepareList_(const IParameterList* p_list);
+    u32 prepareObj_(const IParameterObj* p_obj);
+    static u32 calcParameterSize_(const ParameterBase* p_param);
+
+    u8* writeList_(u8* dst, const IParameterList* p_list, bool include, bool is_le);
+    u8* writeObj_(u8* dst, const IParameterObj* p_obj, bool is_le);
+    static u8* writeParameter_(u8* dst, const ParameterBase* p_param, bool is_le);
+
+    void callPostWrite_();
+
+private:
+    const IParameterList*   mpRoot;
+    std::string             mType;
+    u32                     mTypeVersion;
+    u32                     mArchiveSize;
+    std::vector<bool>       mInclude;       // preWrite_() result of every visited node, in writing order
+    std::vector<Node>       mIncludedNode;
+    u32                     mIncludeIndex;
+    bool                    mIsPostWritten;
+};
+
+} }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <utility/aglParameterApplyPlan.h>
 #include <utility/aglParameterList.h>
 #include <utility/aglResParameter.h>
 
@@ -15,10 +16,25 @@ public:
     virtual ~IParameterIO() { }
 
 public:
-    virtual bool save(const char*, u32) const;
+    enum SaveFlag
+    {
+        cSaveFlag_BigEndian = 1 << 0
+    };
+
+public:
+    // Writes this tree as a binary parameter archive through FileIOMgr. flag is a combination of SaveFlag.
+    virtual bool save(const char* file_path, u32 flag) const;
     virtual void applyResParameterArchive(ResParameterArchive arc);
     virtual void applyResParameterArchiveLerp(ResParameterArchive arc_a, ResParameterArchive arc_b, f32 t);
 
+    // Size of the binary parameter archive written by writeArchive().
+    // Both call preWrite_() and postWrite_() of the tree, so their results must not change in between; save() calls them once.
+    u32 calcArchiveSize() const;
+
+    // Writes this tree as a binary parameter archive to dst, which must be at least calcArchiveSize() bytes large and 4-byte aligned.
+    // Returns the size of the archive, or 0 on failure.
+    u32 writeArchive(void* dst, u32 dst_size, bool is_le = true) const;
+
 protected:
     virtual void callbackInvalidVersion_(ResParameterArchive arc) { }
 
@@ -28,11 +44,32 @@ public:
         mpDelegate = delegate;
     }
 
+    // Records how the last archive was matched against this tree and replays that while the same archive is applied again.
+    // The archive must not be modified in place in a way that changes its layout while this is enabled.
+    void setUseApplyPlan(bool use)
+    {
+        mIsUseApplyPlan = use;
+        if (!use)
+            mApplyPlan.clear();
+    }
+
+    bool isUseApplyPlan() const
+    {
+        return mIsUseApplyPlan;
+    }
+
+    void invalidateApplyPlan()
+    {
+        mApplyPlan.clear();
+    }
+
 protected:
     std::string mType;
     u32 mVersion;
     void* mpDelegate; // sead delegate
     std::string _d4;
+    ParameterApplyPlan mApplyPlan;
+    bool mIsUseApplyPlan;
 };
 //static_assert(sizeof(IParameterIO) == 0x1E0, "agl::utl::IParameterIO size mismatch");
 
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <container/OffsetList.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace agl { namespace utl {
+
+// Children of an OffsetList sorted by name hash, so that applying a resource does not walk the list for every entry.
+// Built on first use after invalidate(). Children sharing a hash keep their list order.
+// Children marked as custom (e.g. with an isApply_() accepting other names) are also kept in a separate list,
+// so that findFirst() can try them for any hash without walking all children.
+template <typename T>
+class ParameterIndex
+{
+public:
+    struct Entry
+    {
+        u32 hash;
+        u32 order;  // Position in the list
+        T*  ptr;
+    };
+
+public:
+    ParameterIndex()
+        : mIsValid(false)
+    {
+    }
+
+    void invalidate()
+    {
+        mIsValid = false;
+    }
+
+    // get_hash is called as u32(const T&) for every child
+    template <typename GetHash>
+    void update(const OffsetList<T>& list, GetHash get_hash)
+    {
+        update(list, get_hash, [](const T&) { return false; });
+    }
+
+    // get_hash and is_custom are called as u32(const T&) and bool(const T&) for every child
+    template <typename GetHash, typename IsCustom>
+    void update(const OffsetList<T>& list, GetHash get_hash, IsCustom is_custom)
+    {
+        if (mIsValid)
+            return;
+
+        mEntry.clear();
+        mCustom.clear();
+        for (typename OffsetList<T>::iterator itr = list.begin(), itr_end = list.end(); itr != itr_end; ++itr)
+        {
+            const Entry entry = { get_hash(*itr), u32(mEntry.size()), &(*itr) };
+            mEntry.push_back(entry);
+
+            if (is_custom(*itr))
+                mCustom.push_back(entry);
+        }
+
+        std::stable_sort(
+            mEntry.begin(), mEntry.end(),
+            [](const Entry& lhs, const Entry& rhs) { return lhs.hash < rhs.hash; }
+        );
+
+        mIsValid = true;
+    }
+
+    // Children with the given hash in [*p_begin, *p_end), in list order
+    void find(u32 hash, const Entry** p_begin, const Entry** p_end) const
+    {
+        RIO_ASSERT(mIsValid);
+
+        const Entry* const begin = mEntry.data();
+        const Entry* const end = begin + mEntry.size();
+
+        *p_begin = std::lower_bound(begin, end, hash, [](const Entry& entry, u32 value) { return entry.hash < value; });
+        *p_end = *p_begin;
+        while (*p_end != end && (*p_end)->hash == hash)
+            ++*p_end;
+    }
+
+    // First child in list order for which pred, called as bool(const T&), returns true.
+    // Only the children with the given hash and the custom children are tried.
+    template <typename Pred>
+    T* findFirst(u32 hash, Pred pred) const
+    {
+        const Entry* begin;
+        const Entry* end;
+        find(hash, &begin, &end);
+
+        const Entry* custom = mCustom.data();
+        const Entry* const custom_end = custom + mCustom.size();
+
+        for (;;)
+        {
+            // Custom children with the hash are already in [begin, end)
+            while (custom != custom_end && custom->hash == hash)
+                ++custom;
+
+            const Entry* entry;
+            if (begin != end && (custom == custom_end || begin->order < custom->order))
+                entry = begin++;
+            else if (custom != custom_end)
+                entry = custom++;
+            else
+                return nullptr;
+
+            if (pred(*entry->ptr))
+                return entry->ptr;
+        }
+    }
+
+private:
+    std::vector<Entry> mEntry;
+    std::vector<Entry> mCustom; // In list order
+    bool mIsValid;
+};
+
+} }
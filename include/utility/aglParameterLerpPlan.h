@@ -0,0 +1,62 @@
+#pragma once
+
+#include <misc/rio_Types.h>
+
+#include <vector>
+
+namespace agl { namespace utl {
+
+class IParameterList;
+class IParameterObj;
+class ParameterBase;
+
+// Flattened result of matching a parameter tree against two trees of the same layout.
+// The float components of every matched f32 and vector parameter are gathered into contiguous arrays and blended in one pass,
+// instead of walking the three trees and dispatching ParameterBase::copyLerp() for every parameter.
+// The plan keeps pointers to a and b, so it is rebuilt whenever they change or any of the three trees is modified.
+class ParameterLerpPlan
+{
+public:
+    ParameterLerpPlan();
+
+    void build(IParameterList* p_dst, const IParameterList* p_a, const IParameterList* p_b);
+    void clear();
+
+    bool isValid(const IParameterList* p_dst, const IParameterList* p_a, const IParameterList* p_b) const;
+
+    void apply(f32 t);
+
+private:
+    struct Copy
+    {
+        ParameterBase*          p_dst;
+        const ParameterBase*    p_src;
+    };
+
+    struct Lerp
+    {
+        ParameterBase*          p_dst;
+        const ParameterBase*    p_a;
+        const ParameterBase*    p_b;
+    };
+
+    void buildList_(IParameterList* p_dst, const IParameterList* p_a, const IParameterList* p_b);
+    void buildObj_(IParameterObj* p_dst, const IParameterObj* p_a, const IParameterObj* p_b);
+
+    static void lerp_(f32* dst, const f32* a, const f32* b, u32 num, f32 t);
+
+private:
+    std::vector<f32*>       mDst;       // One entry per float component
+    std::vector<const f32*> mSrcA;
+    std::vector<const f32*> mSrcB;
+    std::vector<f32>        mBufferA;   // Gathered components of a, then the result
+    std::vector<f32>        mBufferB;   // Gathered components of b
+    std::vector<Copy>       mCopy;      // Parameters which are not interpolated (bool, int, string)
+    std::vector<Lerp>       mLerp;      // Parameters interpolated by their own copyLerp() (color, through rio::Color4f::setLerp())
+    const IParameterList*   mpDst;
+    const IParameterList*   mpA;
+    const IParameterList*   mpB;
+    u32                     mTreeRevision[3];   // Of mpDst, mpA and mpB when the plan was built
+};
+
+} }
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <container/OffsetList.h>
+#include <utility/aglParameter.h>
+#include <utility/aglParameterIndex.h>
+#include <utility/aglParameterLerpPlan.h>
 #include <utility/aglResParameter.h>
 
 #include <string>
@@ -14,10 +17,19 @@ class IParameterList
 public:
     IParameterList();
 
-    void addObj(IParameterObj* child, const char* name);
+    void addObj(IParameterObj* child, const ParameterName& name);
+    void addList(IParameterList* child, const ParameterName& name);
 
     void applyResParameterList(ResParameterList list);
 
+    // Sets every parameter of this tree to the interpolation of the same parameter in a and b, as ParameterBase::copyLerp() does.
+    // The matching of the three trees is kept, so blending the same presets again only runs over flat arrays.
+    void lerp(const IParameterList& a, const IParameterList& b, f32 t);
+
+    // Changes whenever a parameter, object or list is added or renamed anywhere in the tree below this list.
+    // Used to invalidate the apply and lerp plans built for this tree.
+    u32 getTreeRevision() const { return mTreeRevision; }
+
 protected:
     virtual bool preWrite_() const { return true; }
     virtual void postWrite_() const { }
@@ -26,20 +38,46 @@ protected:
     virtual bool isApply_(ResParameterList list) const { return list.getParameterListNameHash() == mNameHash; }
     virtual void callbackNotAppliable_(IParameterObj*, ResParameter) { }
 
-    void setParameterListName_(const char* name);
+    void setParameterListName_(const ParameterName& name);
+
+    // Must be called by derived classes whose isApply_() accepts names other than their own.
+    // The parent only tries the children with the name's hash and these when applying a resource.
+    void setCustomApply_();
+
+    // Bumps the revision of this list and all its ancestors
+    void notifyTreeChanged_();
 
     void applyResParameterList_(ResParameterList list, bool lerp = false, f32 t = 1.0f);
     void applyResParameterListB_(ResParameterList list, f32 t);
 
+    IParameterObj* findObj_(ResParameterObj obj);
+    IParameterList* findList_(ResParameterList list);
+
+    IParameterObj* findObjByHash_(u32 name_hash) const;
+    IParameterList* findListByHash_(u32 name_hash) const;
+
+private:
+    void updateObjIndex_() const;
+    void updateListIndex_() const;
+
 protected:
     OffsetList<IParameterList> mChildList;
     OffsetList<IParameterObj> mChildObj;
+    mutable ParameterIndex<IParameterList> mChildListIndex;
+    mutable ParameterIndex<IParameterObj> mChildObjIndex;
+    ParameterLerpPlan mLerpPlan;
     std::string mName;
     u32 mNameHash;
     u32 _70;
     rio::LinkListNode mListNode;
+    IParameterList* mpParent;
+    u32 mTreeRevision;
+    bool mIsCustomApply;
 
     friend class IParameterObj;
+    friend class ParameterApplyPlan;
+    friend class ParameterArchiveWriter;
+    friend class ParameterLerpPlan;
 };
 //static_assert(sizeof(IParameterList) == 0x80, "agl::utl::IParameterList size mismatch");
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <container/OffsetList.h>
+#include <utility/aglParameterIndex.h>
 #include <utility/aglResParameter.h>
 
 #include <string>
@@ -26,14 +27,27 @@ protected:
     virtual void postRead_() { }
     virtual bool isApply_(ResParameterObj obj) const { return obj.getParameterObjNameHash() == mNameHash; }
 
+    // Must be called by derived classes whose isApply_() accepts names other than their own.
+    // The parent only tries the children with the name's hash and these when applying a resource.
+    void setCustomApply_();
+
+    ParameterBase* findParameter_(u32 name_hash) const;
+    void notifyNotAppliable_(ResParameter res, IParameterList* p_list);
+
 protected:
     OffsetList<ParameterBase> mChildParameter;
+    mutable ParameterIndex<ParameterBase> mChildParameterIndex;
     std::string mName;
     u32 mNameHash;
     u32 mChildHash;
     rio::LinkListNode mListNode;
+    IParameterList* mpParent;
+    bool mIsCustomApply;
 
     friend class IParameterList;
+    friend class ParameterApplyPlan;
+    friend class ParameterArchiveWriter;
+    friend class ParameterLerpPlan;
 };
 //static_assert(sizeof(IParameterObj) == 0x70, "agl::utl::IParameterObj size mismatch");
 
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <misc/rio_Types.h>
+
+#include <string>
+
+// Incremental 128-bit non-cryptographic hash for content keys.
+// Four xxHash64-style lanes consume 32 bytes per round; the lanes and the tail are
+// folded into two independently finalized 64-bit halves.
+//
+// usage: 1) feed data with update() as many times as needed
+//        2) read the result with digest() or hexdigest()
+class Hash128
+{
+public:
+    Hash128(u64 seed = 0);
+
+    void reset(u64 seed = 0);
+    void update(const void* data, size_t size);
+
+    // Does not modify the state, so more data can still be added afterwards
+    void digest(u64* p_high, u64* p_low) const;
+    std::string hexdigest() const;
+
+private:
+    static constexpr s32 cStripeSize = 32;
+
+    u64 mLane[4];
+    u64 mSeed;
+    u64 mTotalSize;
+    u8  mBuffer[cStripeSize];   // Bytes not yet consumed by a full round
+    s32 mBufferSize;
+};
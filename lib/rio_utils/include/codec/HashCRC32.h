@@ -2,13 +2,75 @@
 
 #include <misc/rio_Types.h>
 
+// Lookup tables for slice-by-8, generated at compile time.
+// Table 0 is the classic byte-at-a-time table; table k advances a byte k more times.
+class HashCRC32Table
+{
+public:
+    static constexpr s32 cSliceNum = 8;
+
+public:
+    constexpr HashCRC32Table()
+        : mTable()
+    {
+        for (u32 i = 0; i < 256; i++)
+        {
+            u32 x = i;
+            for (u32 j = 0; j < 8; j++)
+            {
+                if (x & 1)
+                    x = x >> 1 ^ 0xedb88320;
+                else
+                    x >>= 1;
+            }
+            mTable[0][i] = x;
+        }
+
+        for (s32 k = 1; k < cSliceNum; k++)
+            for (u32 i = 0; i < 256; i++)
+                mTable[k][i] = mTable[k - 1][i] >> 8 ^ mTable[0][mTable[k - 1][i] & 0xff];
+    }
+
+    constexpr u32 get(s32 slice, u32 index) const
+    {
+        return mTable[slice][index];
+    }
+
+private:
+    u32 mTable[cSliceNum][256];
+};
+
 class HashCRC32
 {
 public:
-    static void initialize();
-    static u32 calcHash(const void* dataptr, u32 datasize);
+    // Tables are generated at compile time, so there is nothing left to initialize
+    static void initialize() { }
+    static u32 calcHash(const void* dataptr, u32 datasize)
+    {
+        return updateHash(0, dataptr, datasize);
+    }
+
+    // Continues a hash, so that updateHash(calcHash(a), b) == calcHash(a followed by b)
+    static u32 updateHash(u32 hash, const void* dataptr, u32 datasize);
+
+    // Hash of a string literal without the null terminator, usable in constant expressions
+    template <u32 N>
+    static constexpr u32 calcHash(const char (&str)[N])
+    {
+        return calcStringHash(str, N - 1);
+    }
+
+    // Byte-at-a-time version of calcHash() usable in constant expressions
+    static constexpr u32 calcStringHash(const char* str, u32 len)
+    {
+        u32 hash = 0xFFFFFFFF;
+
+        for (u32 i = 0; i < len; i++)
+            hash = hash >> 8 ^ cTable.get(0, (hash ^ u8(str[i])) & 0xff);
+
+        return ~hash;
+    }
 
 private:
-    static u32 sTable[256];
-    static bool sInitialized;
+    static constexpr HashCRC32Table cTable = HashCRC32Table();
 };
@@ -14,6 +14,8 @@ public:
     static std::string sTempPath;
     static std::string sGx2ShaderDecompilerPath;
     static std::string sSpirvCrossPath;
+    static u64 sCacheSizeMax; // Size limit of the decompiled programs kept in sTempPath, in bytes (0 = no limit)
+    static bool sUseMD5Key;   // Key the cache by MD5 of the serialized shaders like older versions, to keep using their cache
 
 public:
     static bool decompileGsh(
@@ -23,4 +25,17 @@ public:
         const std::string& out_vert_fname, const std::string& out_frag_fname /* ,
       //const std::string& out_geom_fname, // <-- TODO */
     );
+
+    // Decompiles the program into the cache only, so that a later decompileGsh() of it does not need to run the decompilers.
+    // Can be called from several threads at once.
+    static bool cacheGsh(
+        const GX2VertexShader& vertex_shader,
+        const GX2PixelShader& pixel_shader
+    );
+
+    // Writes the cache index to sTempPath. Also done on exit.
+    static void flushCache();
+
+private:
+    static bool isDecompilerAvailable_();
 };
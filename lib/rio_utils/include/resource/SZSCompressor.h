@@ -0,0 +1,40 @@
+#pragma once
+
+#include <misc/rio_Types.h>
+
+class SZSCompressor
+{
+public:
+    enum Level
+    {
+        LEVEL_FAST = 0,     // Greedy parsing, short hash chains
+        LEVEL_DEFAULT,      // Lazy matching
+        LEVEL_OPTIMAL,      // Full window search, minimal-size parsing
+    };
+
+public:
+    static inline u32 getHeaderSize()
+    {
+        return 0x10;
+    }
+
+    // Worst case size of the compressed data (every byte stored as a literal)
+    static inline u32 getRequiredMemorySize(u32 src_size)
+    {
+        return getHeaderSize() + src_size + (src_size + 7) / 8;
+    }
+
+    // Compresses src into dst, which must be at least getRequiredMemorySize(src_size) bytes large.
+    // decomp_alignment is stored in the header and later reported by SZSDecompressor::getDecompAlignment().
+    // Returns the compressed size, or 0 on failure.
+    static u32 encode(
+        void* dst, u32 dst_size, const void* src, u32 src_size,
+        Level level = LEVEL_DEFAULT, u32 decomp_alignment = 0
+    );
+
+    // Same as encode(), but allocates the output with rio::MemUtil::alloc().
+    static u8* tryCompress(
+        const void* src, u32 src_size, u32* out_size,
+        Level level = LEVEL_DEFAULT, u32 decomp_alignment = 0, s32 alignment = 0x20
+    );
+};
@@ -2,6 +2,9 @@
 
 #include <filedevice/rio_FileDeviceMgr.h>
 
+#include <span>
+#include <vector>
+
 class SZSDecompressor
 {
 public:
@@ -31,9 +34,27 @@ public:
         u8      headerSize;
     };
 
+    typedef void (*ProgressCallback)(u32 decomp_done, u32 decomp_size, void* user_data);
+
+    static constexpr u32 cStreamChunkSize = 0x10000;
+
 public:
     static u8* tryDecomp(rio::FileDevice::LoadArg& arg, bool reject_uncompressed = true);
 
+    // Reads the file in chunks of chunk_size bytes and decompresses each chunk as soon as it is read,
+    // so that the compressed file is never held in memory as a whole.
+    // Only SZS files are accepted. callback, if set, is called after each chunk.
+    static u8* tryDecompStreaming(
+        rio::FileDevice::LoadArg& arg, u32 chunk_size = cStreamChunkSize,
+        ProgressCallback callback = nullptr, void* user_data = nullptr
+    );
+
+    // Loads and decompresses every file of args, with the same semantics as tryDecomp(arg) for each of them.
+    // Files are read in order on the calling thread while up to thread_num workers decode the ones already read
+    // (thread_num <= 0: one per hardware thread).
+    // Returns the decompressed buffers (nullptr on failure) in the order of args.
+    static std::vector<u8*> tryDecompBatch(std::span<rio::FileDevice::LoadArg> args, bool reject_uncompressed = true, s32 thread_num = 0);
+
     static inline u8* tryDecomp(
         const u8* src, u32 src_size,
         u8* dst = nullptr, u32 dst_size = 0, s32 alignment = 0,
@@ -48,12 +69,19 @@ public:
     }
 
 private:
+    static const u8* loadSrc_(const rio::FileDevice::LoadArg& arg, bool reject_uncompressed, u32* src_size);
+
     static u8* tryDecomp_(
         const u8* src, u32 src_size, bool src_need_delete, bool reject_uncompressed,
         u8* dst, u32 dst_size, s32 alignment,
         u32* out_size, u32* out_buffer_size, bool* out_need_delete
     );
 
+    static u8* prepareDst_(
+        const void* header, u8* dst, u32 dst_size, s32 alignment,
+        u32* out_decomp_size, u32* out_buffer_size, bool* out_need_delete
+    );
+
 public:
     static inline u32 getHeaderSize()
     {
@@ -66,6 +94,12 @@ public:
 
 #if RIO_IS_CAFE
     static s32 decomp(void* dst, u32 dst_size, const void* src, u32 src_size);
+#else
+    // One-shot decompression of a whole SZS buffer.
+    // Output is identical to streamDecomp() with forceDestCount = dst_size,
+    // but literal runs and matches are copied a word at a time.
+    // Returns a negative value on error, otherwise the number of bytes of dst which could not be filled.
+    static s32 decompFast(void* dst, u32 dst_size, const void* src, u32 src_size);
 #endif // RIO_IS_CAFE
     static s32 streamDecomp(DecompContext* context, const void* src, u32 len);
 
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <resource/SharcArchiveRes.h>
+
+#include <string>
+#include <vector>
+
+class SharcArchiveBuilder
+{
+public:
+    static constexpr u32 cDefaultHashKey    = 0x65;
+    static constexpr u32 cDefaultAlignment  = 4;
+
+public:
+    SharcArchiveBuilder(bool is_big_endian = false, u32 hash_key = cDefaultHashKey)
+        : mIsBigEndian(is_big_endian)
+        , mHashKey(hash_key)
+    {
+    }
+
+    void setBigEndian(bool is_big_endian) { mIsBigEndian = is_big_endian; }
+    bool isBigEndian() const { return mIsBigEndian; }
+
+    void setHashKey(u32 hash_key) { mHashKey = hash_key; }
+    u32 getHashKey() const { return mHashKey; }
+
+    // data is not copied and must stay valid until the archive is built.
+    // alignment must be a power of 2 and applies to the offset of the file in the archive.
+    void addFile(const char* file_path, const void* data, u32 size, u32 alignment = cDefaultAlignment);
+
+    void clear() { mEntry.clear(); }
+
+    s32 getFileNum() const { return mEntry.size(); }
+
+    // Returns the size of the archive, or 0 if it cannot be built.
+    u32 calcArchiveSize() const;
+
+    // Writes the archive to dst, which must be at least calcArchiveSize() bytes large.
+    // Returns the size of the archive, or 0 on failure.
+    u32 build(void* dst, u32 dst_size) const;
+
+    // Same as above, but resizes dst to fit the archive.
+    u32 build(std::vector<u8>& dst) const;
+
+private:
+    struct Entry
+    {
+        std::string path;
+        const void* data;
+        u32         size;
+        u32         alignment;
+    };
+
+    struct Layout
+    {
+        std::vector<s32>    order;          // Entries sorted by hash
+        std::vector<u32>    hash;           // In sorted order
+        std::vector<u32>    name_offset;    // FNT offsets, in sorted order
+        std::vector<u32>    data_offset;    // Data block offsets, in sorted order
+        u32                 fnt_size;
+        u32                 data_block_offset;
+        u32                 file_size;
+    };
+
+    bool calcLayout_(Layout* layout) const;
+    void write_(const Layout& layout, u8* dst) const;
+
+private:
+    bool                mIsBigEndian;
+    u32                 mHashKey;
+    std::vector<Entry>  mEntry;
+};
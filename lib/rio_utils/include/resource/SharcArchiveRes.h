@@ -3,6 +3,7 @@
 #include <misc/rio_Types.h>
 
 #include <span>
+#include <string>
 #include <vector>
 
 class SharcArchiveRes
@@ -89,19 +90,53 @@ public:
         , mFATBlockHeader(nullptr)
         , mFNTBlock(nullptr)
         , mDataBlock(nullptr)
+#ifdef __linux__
+        , mMappedArchive(nullptr)
+        , mMappedSize(0)
+#endif // __linux__
     {
     }
 
+#ifdef __linux__
+    ~SharcArchiveRes()
+    {
+        unmapArchive_();
+    }
+#endif // __linux__
+
+    SharcArchiveRes(const SharcArchiveRes&) = delete;
+    SharcArchiveRes& operator=(const SharcArchiveRes&) = delete;
+
     void destroy()
     {
+#ifdef __linux__
+        unmapArchive_();
+#endif // __linux__
         mArchiveBlockHeader = nullptr;
         mFATBlockHeader = nullptr;
         mFNTBlock = nullptr;
         mFATEntrys = std::span<const FATEntry>();
         mDataBlock = nullptr;
+        mIndexSlots.clear();
+        mIndexNames.clear();
     }
 
-    bool prepareArchive(const void* archive, bool fatal_errors = true);
+    // If build_index is true, a host-endian hash table of the FAT is built,
+    // which turns path lookups into a single probe instead of a binary search over the FAT.
+    bool prepareArchive(const void* archive, bool fatal_errors = true, bool build_index = false);
+
+    bool isIndexBuilt() const { return !mIndexSlots.empty(); }
+
+#ifdef __linux__
+    // Maps the archive at native_path into memory instead of loading it, and prepares it.
+    // Pages are only read from disk when first accessed, and files are returned as pointers into the mapping.
+    // If writable is true the mapping is copy-on-write, so that getFileMutable() data can be modified
+    // in place (e.g. endian swapping of resources) without touching the file.
+    // The mapping is owned by this object and released by destroy().
+    bool mapArchive(const std::string& native_path, bool writable = true, bool fatal_errors = true, bool build_index = false);
+
+    bool isMapped() const { return mMappedArchive != nullptr; }
+#endif // __linux__
 
     std::vector<Entry> readEntry(u32 first = 0, u32 num = u32(-1)) const;
 
@@ -133,6 +168,16 @@ private:
     void* getFileFastImpl_(s32 entry_id, FileInfo* file_info = nullptr) const;
 
     s32 convertPathToEntryIDImpl_(const char* file_path) const;
+    s32 convertPathToEntryIDIndexed_(const char* file_path) const;
+
+    // Offsets in the headers and FAT are only checked against archive_size if it is not cArchiveSizeUnknown
+    bool prepareArchive_(const void* archive, size_t archive_size, bool fatal_errors, bool build_index);
+
+    void buildIndex_();
+
+#ifdef __linux__
+    void unmapArchive_();
+#endif // __linux__
 
     static void setFileInfo_(FileInfo* file_info, u32 start_offset, u32 length)
     {
@@ -141,6 +186,17 @@ private:
         file_info->mLength      = length;
     }
 
+private:
+    static constexpr size_t cArchiveSizeUnknown = size_t(-1);
+
+    struct IndexSlot
+    {
+        u32 hash;
+        u16 entry_id;   // First FAT entry with this hash
+        u16 entry_num;  // Number of consecutive FAT entries with this hash (0: empty slot)
+    };
+    static_assert(sizeof(IndexSlot) == 8);
+
 private:
     const ArchiveBlockHeader*   mArchiveBlockHeader;
     const FATBlockHeader*       mFATBlockHeader;
@@ -148,4 +204,11 @@ private:
     std::span<const FATEntry>   mFATEntrys;
     const u8*                   mDataBlock;
     bool                        mIsBigEndian;
+    u32                         mHashKey;
+    std::vector<IndexSlot>      mIndexSlots;
+    std::vector<const char*>    mIndexNames;
+#ifdef __linux__
+    void*                       mMappedArchive;
+    size_t                      mMappedSize;
+#endif // __linux__
 };
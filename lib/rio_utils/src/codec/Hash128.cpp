@@ -0,0 +1,213 @@
+#include <codec/Hash128.h>
+
+#include <cstring>
+
+namespace {
+
+constexpr u64 cPrime1 = 0x9E3779B185EBCA87ull;
+constexpr u64 cPrime2 = 0xC2B2AE3D27D4EB4Full;
+constexpr u64 cPrime3 = 0x165667B19E3779F9ull;
+constexpr u64 cPrime4 = 0x85EBCA77C2B2AE63ull;
+constexpr u64 cPrime5 = 0x27D4EB2F165667C5ull;
+
+inline u64 RotL(u64 x, s32 r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+inline u64 Read64(const u8* p)
+{
+    // Content keys must not depend on the host byte order
+    return u64(p[0])       | u64(p[1]) << 8  | u64(p[2]) << 16 | u64(p[3]) << 24 |
+           u64(p[4]) << 32 | u64(p[5]) << 40 | u64(p[6]) << 48 | u64(p[7]) << 56;
+}
+
+inline u32 Read32(const u8* p)
+{
+    return u32(p[0]) | u32(p[1]) << 8 | u32(p[2]) << 16 | u32(p[3]) << 24;
+}
+
+inline u64 Round(u64 acc, u64 input)
+{
+    acc += input * cPrime2;
+    acc = RotL(acc, 31);
+    return acc * cPrime1;
+}
+
+inline u64 MergeRound(u64 acc, u64 lane)
+{
+    acc ^= Round(0, lane);
+    return acc * cPrime1 + cPrime4;
+}
+
+inline u64 Avalanche(u64 h)
+{
+    h ^= h >> 33;
+    h *= cPrime2;
+    h ^= h >> 29;
+    h *= cPrime3;
+    h ^= h >> 32;
+    return h;
+}
+
+// Different shifts and multipliers than Avalanche(), so that both halves are not related
+inline u64 Avalanche2(u64 h)
+{
+    h ^= h >> 37;
+    h *= 0x165667919E3779F9ull;
+    h ^= h >> 32;
+    return h;
+}
+
+}
+
+Hash128::Hash128(u64 seed)
+{
+    reset(seed);
+}
+
+void Hash128::reset(u64 seed)
+{
+    mLane[0] = seed + cPrime1 + cPrime2;
+    mLane[1] = seed + cPrime2;
+    mLane[2] = seed;
+    mLane[3] = seed - cPrime1;
+    mSeed = seed;
+    mTotalSize = 0;
+    mBufferSize = 0;
+}
+
+void Hash128::update(const void* data, size_t size)
+{
+    if (size == 0)
+        return;
+
+    const u8* p = static_cast<const u8*>(data);
+    const u8* const end = p + size;
+
+    mTotalSize += size;
+
+    if (mBufferSize + size < size_t(cStripeSize))
+    {
+        std::memcpy(mBuffer + mBufferSize, p, size);
+        mBufferSize += size;
+        return;
+    }
+
+    if (mBufferSize > 0)
+    {
+        const s32 fill = cStripeSize - mBufferSize;
+        std::memcpy(mBuffer + mBufferSize, p, fill);
+        p += fill;
+
+        mLane[0] = Round(mLane[0], Read64(mBuffer + 0));
+        mLane[1] = Round(mLane[1], Read64(mBuffer + 8));
+        mLane[2] = Round(mLane[2], Read64(mBuffer + 16));
+        mLane[3] = Round(mLane[3], Read64(mBuffer + 24));
+        mBufferSize = 0;
+    }
+
+    // Lanes are independent, so the rounds of one stripe can overlap
+    u64 v0 = mLane[0];
+    u64 v1 = mLane[1];
+    u64 v2 = mLane[2];
+    u64 v3 = mLane[3];
+
+    for (; p + cStripeSize <= end; p += cStripeSize)
+    {
+        v0 = Round(v0, Read64(p + 0));
+        v1 = Round(v1, Read64(p + 8));
+        v2 = Round(v2, Read64(p + 16));
+        v3 = Round(v3, Read64(p + 24));
+    }
+
+    mLane[0] = v0;
+    mLane[1] = v1;
+    mLane[2] = v2;
+    mLane[3] = v3;
+
+    if (p < end)
+    {
+        mBufferSize = end - p;
+        std::memcpy(mBuffer, p, mBufferSize);
+    }
+}
+
+void Hash128::digest(u64* p_high, u64* p_low) const
+{
+    u64 lo;
+    u64 hi;
+
+    if (mTotalSize >= u64(cStripeSize))
+    {
+        lo = RotL(mLane[0], 1) + RotL(mLane[1], 7) + RotL(mLane[2], 12) + RotL(mLane[3], 18);
+        lo = MergeRound(lo, mLane[0]);
+        lo = MergeRound(lo, mLane[1]);
+        lo = MergeRound(lo, mLane[2]);
+        lo = MergeRound(lo, mLane[3]);
+
+        hi = RotL(mLane[0], 29) + RotL(mLane[1], 41) + RotL(mLane[2], 3) + RotL(mLane[3], 53);
+        hi = MergeRound(hi, mLane[3]);
+        hi = MergeRound(hi, mLane[2]);
+        hi = MergeRound(hi, mLane[1]);
+        hi = MergeRound(hi, mLane[0]);
+    }
+    else
+    {
+        lo = mSeed + cPrime5;
+        hi = mSeed ^ cPrime3;
+    }
+
+    lo += mTotalSize;
+    hi += mTotalSize * cPrime4;
+
+    const u8* p = mBuffer;
+    const u8* const end = mBuffer + mBufferSize;
+
+    for (; p + 8 <= end; p += 8)
+    {
+        const u64 k = Read64(p);
+        lo ^= Round(0, k);
+        lo = RotL(lo, 27) * cPrime1 + cPrime4;
+        hi ^= Round(cPrime5, k);
+        hi = RotL(hi, 31) * cPrime2 + cPrime3;
+    }
+
+    if (p + 4 <= end)
+    {
+        const u64 k = Read32(p);
+        lo ^= k * cPrime1;
+        lo = RotL(lo, 23) * cPrime2 + cPrime3;
+        hi ^= k * cPrime3;
+        hi = RotL(hi, 19) * cPrime1 + cPrime5;
+        p += 4;
+    }
+
+    for (; p < end; p++)
+    {
+        lo ^= *p * cPrime5;
+        lo = RotL(lo, 11) * cPrime1;
+        hi ^= *p * cPrime1;
+        hi = RotL(hi, 13) * cPrime5;
+    }
+
+    lo = Avalanche(lo);
+    hi = Avalanche2(hi ^ lo);
+
+    *p_high = hi;
+    *p_low = lo;
+}
+
+std::string Hash128::hexdigest() const
+{
+    static const char cHexDigit[] = "0123456789abcdef";
+
+    u64 value[2];
+    digest(&value[0], &value[1]);
+
+    std::string ret(32, '0');
+    for (s32 i = 0; i < 32; i++)
+        ret[i] = cHexDigit[value[i / 16] >> (60 - (i % 16) * 4) & 0xf];
+
+    return ret;
+}
@@ -1,37 +1,39 @@
 #include <codec/HashCRC32.h>
 
-u32 HashCRC32::sTable[256];
-bool HashCRC32::sInitialized = false;
+namespace {
 
-void HashCRC32::initialize()
+inline u32 ReadU32LE(const u8* p)
 {
-    u32 x = 0;
-    for (u32 i = 0; i < 256; i++)
-    {
-        x = i;
-        for (u32 j = 0; j < 8; j++)
-        {
-            if (x & 1)
-                x = x >> 1 ^ 0xedb88320;
-            else
-                x >>= 1;
-        }
-        sTable[i] = x;
-    }
-    sInitialized = true;
+    return u32(p[0]) | u32(p[1]) << 8 | u32(p[2]) << 16 | u32(p[3]) << 24;
 }
 
-u32 HashCRC32::calcHash(const void* dataptr, u32 datasize)
-{
-    if (!sInitialized)
-        initialize();
+}
 
-    u32 hash = 0xFFFFFFFF;
+u32 HashCRC32::updateHash(u32 hash, const void* dataptr, u32 datasize)
+{
+    hash = ~hash;
     const u8* dataptr8 = (const u8*)dataptr;
 
-    for (u32 i = 0; i < datasize; i++)
+    // Slice-by-8: the state and 8 bytes of input are folded with one lookup per byte, and the lookups are independent
+    for (; datasize >= 8; datasize -= 8)
+    {
+        const u32 lo = ReadU32LE(dataptr8) ^ hash;
+        const u32 hi = ReadU32LE(dataptr8 + 4);
+        dataptr8 += 8;
+
+        hash = cTable.get(7, lo       & 0xff) ^
+               cTable.get(6, lo >>  8 & 0xff) ^
+               cTable.get(5, lo >> 16 & 0xff) ^
+               cTable.get(4, lo >> 24       ) ^
+               cTable.get(3, hi       & 0xff) ^
+               cTable.get(2, hi >>  8 & 0xff) ^
+               cTable.get(1, hi >> 16 & 0xff) ^
+               cTable.get(0, hi >> 24       );
+    }
+
+    for (; datasize > 0; datasize--)
     {
-        u32 x = sTable[(hash ^ *dataptr8++) & 0xff];
+        u32 x = cTable.get(0, (hash ^ *dataptr8++) & 0xff);
         hash = hash >> 8 ^ x;
     }
 
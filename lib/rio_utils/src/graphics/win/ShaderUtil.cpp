@@ -1,21 +1,35 @@
 #include <graphics/win/ShaderUtil.h>
+#include <codec/Hash128.h>
+#include <codec/HashCRC32.h>
 #include <misc/MD5.h>
 
 #include <filedevice/rio_FileDeviceMgr.h>
 
 #include <cafe/gfd.h>
 
+#ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 #ifndef NOMINMAX
     #define NOMINMAX
 #endif // NOMINMAX
 #include <windows.h>
+#else
+#include <spawn.h>
+#include <sys/wait.h>
+#include <cerrno>
+
+extern char** environ;
+#endif // _WIN32
 
 #include <array>
 #include <algorithm>
+#include <condition_variable>
+#include <filesystem>
 #include <fstream>
+#include <mutex>
 #include <sstream>
 #include <unordered_map>
+#include <unordered_set>
 
 #ifdef RIO_DEBUG
 
@@ -37,18 +51,37 @@ namespace {
 
 bool FileExists(const char* path)
 {
-    DWORD dwAttrib = GetFileAttributes(path);
-    return dwAttrib != INVALID_FILE_ATTRIBUTES && !(dwAttrib & FILE_ATTRIBUTE_DIRECTORY);
+    std::error_code ec;
+    return std::filesystem::is_regular_file(path, ec);
 }
 
 bool FolderExists(const char* path)
 {
-    DWORD dwAttrib = GetFileAttributes(path);
-    return dwAttrib != INVALID_FILE_ATTRIBUTES && (dwAttrib & FILE_ATTRIBUTE_DIRECTORY);
+    std::error_code ec;
+    return std::filesystem::is_directory(path, ec);
+}
+
+bool RemoveFile(const char* path)
+{
+    std::error_code ec;
+    return std::filesystem::remove(path, ec);
+}
+
+// Renames over an existing file, so that readers see either the old or the new complete file
+bool ReplaceFile(const std::string& src, const std::string& dst)
+{
+    std::error_code ec;
+    std::filesystem::rename(src, dst, ec);
+    if (!ec)
+        return true;
+
+    RemoveFile(src.c_str());
+    return false;
 }
 
 void RunCommand(const char* cmd)
 {
+#ifdef _WIN32
     STARTUPINFOA si = { sizeof(STARTUPINFOA), 0 };
     si.dwFlags = STARTF_USESHOWWINDOW;
     si.wShowWindow = SW_HIDE;
@@ -61,6 +94,17 @@ void RunCommand(const char* cmd)
         CloseHandle(pi.hThread);
         CloseHandle(pi.hProcess);
     }
+#else
+    char* const argv[] = { const_cast<char*>("sh"), const_cast<char*>("-c"), const_cast<char*>(cmd), nullptr };
+
+    pid_t pid;
+    if (posix_spawn(&pid, "/bin/sh", nullptr, nullptr, argv, environ) == 0)
+    {
+        int status;
+        while (waitpid(pid, &status, 0) == -1 && errno == EINTR)
+            continue;
+    }
+#endif // _WIN32
 }
 
 bool WriteFile(const char* filename, const u8* data, u32 size)
@@ -477,6 +521,422 @@ void ReplaceString(std::string& str, const std::string& a, const std::string& b)
     }
 }
 
+// Runs the external decompilers on the program and fixes up their output for rio
+bool RunDecompiler(
+    const std::string& key,
+    const GX2VertexShader* vertexShader,
+    const GX2PixelShader* pixelShader,
+    const void* vertexShaderBuf, size_t vertexShaderBufSize,
+    const void* pixelShaderBuf, size_t pixelShaderBufSize,
+    std::string& glVertexShader,
+    std::string& glFragmentShader
+)
+{
+    const std::string& basePath = ShaderUtil::sTempPath + '/' + key;
+
+    const std::string& vertexShaderPath = basePath + "VS";
+    const std::string& fragmentShaderPath = basePath + "FS";
+
+    const std::string& vertexShaderSrcPath = vertexShaderPath + ".vert";
+    const std::string& fragmentShaderSrcPath = fragmentShaderPath + ".frag";
+
+    const std::string& vertexShaderSpirvPath = vertexShaderSrcPath + ".spv";
+    const std::string& fragmentShaderSpirvPath = fragmentShaderSrcPath + ".spv";
+
+    RIO_SHADER_DEBUG_LOG("\n");
+    RIO_SHADER_DEBUG_LOG("%s\n", vertexShaderSpirvPath.c_str());
+    RIO_SHADER_DEBUG_LOG("%s\n", fragmentShaderSpirvPath.c_str());
+
+    WriteFile(vertexShaderPath.c_str(), (u8*)vertexShaderBuf, vertexShaderBufSize);
+    WriteFile(fragmentShaderPath.c_str(), (u8*)pixelShaderBuf, pixelShaderBufSize);
+
+    std::string cmd;
+    {
+        std::ostringstream cmdStrm;
+        cmdStrm << "\"" << ShaderUtil::sGx2ShaderDecompilerPath << "\" -v \"" << vertexShaderPath << "\" -p \"" << fragmentShaderPath << "\"";
+        cmd = cmdStrm.str();
+    }
+    RIO_SHADER_DEBUG_LOG("%s\n", cmd.c_str());
+    RunCommand(cmd.c_str());
+
+    RemoveFile(vertexShaderPath.c_str());
+    RemoveFile(fragmentShaderPath.c_str());
+
+    if (!FileExists(vertexShaderSpirvPath.c_str()))
+        return false;
+
+    if (!FileExists(fragmentShaderSpirvPath.c_str()))
+        return false;
+
+    {
+        std::ostringstream cmdStrm;
+        cmdStrm << "\"" << ShaderUtil::sSpirvCrossPath << "\" \"" << vertexShaderSpirvPath << "\" --no-es "  \
+            "--no-420pack-extension --no-support-nonzero-baseinstance " \
+            "--rename-interface-variable out 0 PARAM_0 " \
+            "--rename-interface-variable out 1 PARAM_1 " \
+            "--rename-interface-variable out 2 PARAM_2 " \
+            "--rename-interface-variable out 3 PARAM_3 " \
+            "--rename-interface-variable out 4 PARAM_4 " \
+            "--rename-interface-variable out 5 PARAM_5 " \
+            "--rename-interface-variable out 6 PARAM_6 " \
+            "--rename-interface-variable out 7 PARAM_7 " \
+            "--rename-interface-variable out 8 PARAM_8 " \
+            "--rename-interface-variable out 9 PARAM_9 " \
+            "--rename-interface-variable out 10 PARAM_10 " \
+            "--rename-interface-variable out 11 PARAM_11 " \
+            "--rename-interface-variable out 12 PARAM_12 " \
+            "--rename-interface-variable out 13 PARAM_13 " \
+            "--rename-interface-variable out 14 PARAM_14 " \
+            "--rename-interface-variable out 15 PARAM_15 " \
+            "--rename-interface-variable out 16 PARAM_16 " \
+            "--rename-interface-variable out 17 PARAM_17 " \
+            "--rename-interface-variable out 18 PARAM_18 " \
+            "--rename-interface-variable out 19 PARAM_19 " \
+            "--rename-interface-variable out 20 PARAM_20 " \
+            "--rename-interface-variable out 21 PARAM_21 " \
+            "--rename-interface-variable out 22 PARAM_22 " \
+            "--rename-interface-variable out 23 PARAM_23 " \
+            "--rename-interface-variable out 24 PARAM_24 " \
+            "--rename-interface-variable out 25 PARAM_25 " \
+            "--rename-interface-variable out 26 PARAM_26 " \
+            "--rename-interface-variable out 27 PARAM_27 " \
+            "--rename-interface-variable out 28 PARAM_28 " \
+            "--rename-interface-variable out 29 PARAM_29 " \
+            "--rename-interface-variable out 30 PARAM_30 " \
+            "--rename-interface-variable out 31 PARAM_31 " \
+            "--rename-interface-variable out 32 PARAM_32 " \
+            "--rename-interface-variable out 33 PARAM_33 " \
+            "--rename-interface-variable out 34 PARAM_34 " \
+            "--rename-interface-variable out 35 PARAM_35 " \
+            "--rename-interface-variable out 36 PARAM_36 " \
+            "--rename-interface-variable out 37 PARAM_37 " \
+            "--rename-interface-variable out 38 PARAM_38 " \
+            "--rename-interface-variable out 39 PARAM_39 " \
+            "--rename-interface-variable out 40 PARAM_40 " \
+            "--rename-interface-variable out 41 PARAM_41 " \
+            "--rename-interface-variable out 42 PARAM_42 " \
+            "--rename-interface-variable out 43 PARAM_43 " \
+            "--rename-interface-variable out 44 PARAM_44 " \
+            "--rename-interface-variable out 45 PARAM_45 " \
+            "--rename-interface-variable out 46 PARAM_46 " \
+            "--rename-interface-variable out 47 PARAM_47 " \
+            "--rename-interface-variable out 48 PARAM_48 " \
+            "--rename-interface-variable out 49 PARAM_49 " \
+            "--rename-interface-variable out 50 PARAM_50 " \
+            "--rename-interface-variable out 51 PARAM_51 " \
+            "--rename-interface-variable out 52 PARAM_52 " \
+            "--rename-interface-variable out 53 PARAM_53 " \
+            "--rename-interface-variable out 54 PARAM_54 " \
+            "--rename-interface-variable out 55 PARAM_55 " \
+            "--rename-interface-variable out 56 PARAM_56 " \
+            "--rename-interface-variable out 57 PARAM_57 " \
+            "--rename-interface-variable out 58 PARAM_58 " \
+            "--rename-interface-variable out 59 PARAM_59 " \
+            "--rename-interface-variable out 60 PARAM_60 " \
+            "--rename-interface-variable out 61 PARAM_61 " \
+            "--rename-interface-variable out 62 PARAM_62 " \
+            "--rename-interface-variable out 63 PARAM_63 " \
+            "--version 410 --output \"" << vertexShaderSrcPath << "\"";
+        cmd = cmdStrm.str();
+    }
+    RIO_SHADER_DEBUG_LOG("%s\n", cmd.c_str());
+    RunCommand(cmd.c_str());
+
+    RemoveFile(vertexShaderSpirvPath.c_str());
+    if (!FileExists(vertexShaderSrcPath.c_str()))
+        return false;
+
+    {
+        std::ostringstream cmdStrm;
+        cmdStrm << "\"" << ShaderUtil::sSpirvCrossPath << "\" \"" << fragmentShaderSpirvPath << "\" --no-es "  \
+            "--no-420pack-extension --no-support-nonzero-baseinstance " \
+            "--rename-interface-variable in 0 PARAM_0 " \
+            "--rename-interface-variable in 1 PARAM_1 " \
+            "--rename-interface-variable in 2 PARAM_2 " \
+            "--rename-interface-variable in 3 PARAM_3 " \
+            "--rename-interface-variable in 4 PARAM_4 " \
+            "--rename-interface-variable in 5 PARAM_5 " \
+            "--rename-interface-variable in 6 PARAM_6 " \
+            "--rename-interface-variable in 7 PARAM_7 " \
+            "--rename-interface-variable in 8 PARAM_8 " \
+            "--rename-interface-variable in 9 PARAM_9 " \
+            "--rename-interface-variable in 10 PARAM_10 " \
+            "--rename-interface-variable in 11 PARAM_11 " \
+            "--rename-interface-variable in 12 PARAM_12 " \
+            "--rename-interface-variable in 13 PARAM_13 " \
+            "--rename-interface-variable in 14 PARAM_14 " \
+            "--rename-interface-variable in 15 PARAM_15 " \
+            "--rename-interface-variable in 16 PARAM_16 " \
+            "--rename-interface-variable in 17 PARAM_17 " \
+            "--rename-interface-variable in 18 PARAM_18 " \
+            "--rename-interface-variable in 19 PARAM_19 " \
+            "--rename-interface-variable in 20 PARAM_20 " \
+            "--rename-interface-variable in 21 PARAM_21 " \
+            "--rename-interface-variable in 22 PARAM_22 " \
+            "--rename-interface-variable in 23 PARAM_23 " \
+            "--rename-interface-variable in 24 PARAM_24 " \
+            "--rename-interface-variable in 25 PARAM_25 " \
+            "--rename-interface-variable in 26 PARAM_26 " \
+            "--rename-interface-variable in 27 PARAM_27 " \
+            "--rename-interface-variable in 28 PARAM_28 " \
+            "--rename-interface-variable in 29 PARAM_29 " \
+            "--rename-interface-variable in 30 PARAM_30 " \
+            "--rename-interface-variable in 31 PARAM_31 " \
+            "--rename-interface-variable in 32 PARAM_32 " \
+            "--rename-interface-variable in 33 PARAM_33 " \
+            "--rename-interface-variable in 34 PARAM_34 " \
+            "--rename-interface-variable in 35 PARAM_35 " \
+            "--rename-interface-variable in 36 PARAM_36 " \
+            "--rename-interface-variable in 37 PARAM_37 " \
+            "--rename-interface-variable in 38 PARAM_38 " \
+            "--rename-interface-variable in 39 PARAM_39 " \
+            "--rename-interface-variable in 40 PARAM_40 " \
+            "--rename-interface-variable in 41 PARAM_41 " \
+            "--rename-interface-variable in 42 PARAM_42 " \
+            "--rename-interface-variable in 43 PARAM_43 " \
+            "--rename-interface-variable in 44 PARAM_44 " \
+            "--rename-interface-variable in 45 PARAM_45 " \
+            "--rename-interface-variable in 46 PARAM_46 " \
+            "--rename-interface-variable in 47 PARAM_47 " \
+            "--rename-interface-variable in 48 PARAM_48 " \
+            "--rename-interface-variable in 49 PARAM_49 " \
+            "--rename-interface-variable in 50 PARAM_50 " \
+            "--rename-interface-variable in 51 PARAM_51 " \
+            "--rename-interface-variable in 52 PARAM_52 " \
+            "--rename-interface-variable in 53 PARAM_53 " \
+            "--rename-interface-variable in 54 PARAM_54 " \
+            "--rename-interface-variable in 55 PARAM_55 " \
+            "--rename-interface-variable in 56 PARAM_56 " \
+            "--rename-interface-variable in 57 PARAM_57 " \
+            "--rename-interface-variable in 58 PARAM_58 " \
+            "--rename-interface-variable in 59 PARAM_59 " \
+            "--rename-interface-variable in 60 PARAM_60 " \
+            "--rename-interface-variable in 61 PARAM_61 " \
+            "--rename-interface-variable in 62 PARAM_62 " \
+            "--rename-interface-variable in 63 PARAM_63 " \
+            "--version 410 --output \"" << fragmentShaderSrcPath << "\"";
+        cmd = cmdStrm.str();
+    }
+    RIO_SHADER_DEBUG_LOG("%s\n", cmd.c_str());
+    RunCommand(cmd.c_str());
+
+    RemoveFile(fragmentShaderSpirvPath.c_str());
+    if (!FileExists(fragmentShaderSrcPath.c_str()))
+        return false;
+
+    {
+        [[maybe_unused]] bool read = ReadFile(vertexShaderSrcPath, &glVertexShader);
+        RIO_ASSERT(read);
+    }
+    RemoveFile(vertexShaderSrcPath.c_str());
+
+    {
+        [[maybe_unused]] bool read = ReadFile(fragmentShaderSrcPath, &glFragmentShader);
+        RIO_ASSERT(read);
+    }
+    RemoveFile(fragmentShaderSrcPath.c_str());
+
+    ReplaceString(glVertexShader, "\r\n", "\n");
+    ReplaceString(glFragmentShader, "\r\n", "\n");
+
+    RIO_ASSERT(vertexShader->shaderMode == GX2_SHADER_MODE_UNIFORM_REGISTERS || vertexShader->shaderMode == GX2_SHADER_MODE_UNIFORM_BLOCKS);
+
+    RIO_SHADER_DEBUG_LOG("Vertex shader mode: %u\n", u32(vertexShader->shaderMode));
+
+    if (vertexShader->shaderMode == GX2_SHADER_MODE_UNIFORM_REGISTERS)
+    {
+        const std::string& formatOldStr = "layout(std430) readonly buffer CFILE_DATA";
+        const std::string& formatNewStr = "layout(std140) uniform VS_CFILE_DATA";
+
+        ReplaceString(glVertexShader, formatOldStr, formatNewStr);
+    }
+    else
+    {
+        std::vector<GX2UniformBlock> vertexUBOs = std::vector<GX2UniformBlock>(vertexShader->uniformBlocks,
+                                                                               vertexShader->uniformBlocks + vertexShader->numUniformBlocks);
+
+        std::sort(vertexUBOs.begin(), vertexUBOs.end(), GX2UniformBlockComp);
+
+        for (u32 i = 0; i < vertexShader->numUniformBlocks; i++)
+        {
+            std::ostringstream formatOldStrm;
+            formatOldStrm << "layout(std430) readonly buffer CBUFFER_DATA_" << vertexUBOs[i].location << std::endl
+                          << "{" << std::endl
+                          << "    vec4 values[];" << std::endl
+                          << "}";
+
+            std::ostringstream formatNewStrm;
+            formatNewStrm << "layout(std140) uniform " << vertexUBOs[i].name << std::endl
+                          << "{" << std::endl
+                          << "    vec4 values[" << ((vertexUBOs[i].size + 15) / 16) << "];" << std::endl
+                          << "}";
+
+            ReplaceString(glVertexShader, formatOldStrm.str(), formatNewStrm.str());
+        }
+    }
+
+    RIO_ASSERT(pixelShader->shaderMode == GX2_SHADER_MODE_UNIFORM_REGISTERS || pixelShader->shaderMode == GX2_SHADER_MODE_UNIFORM_BLOCKS);
+
+    RIO_SHADER_DEBUG_LOG("Pixel shader mode: %u\n", u32(pixelShader->shaderMode));
+
+    if (pixelShader->shaderMode == GX2_SHADER_MODE_UNIFORM_REGISTERS)
+    {
+        const std::string& formatOldStr = "layout(std430) readonly buffer CFILE_DATA";
+        const std::string& formatNewStr = "layout(std140) uniform PS_CFILE_DATA";
+
+        ReplaceString(glFragmentShader, formatOldStr, formatNewStr);
+    }
+    else
+    {
+        std::vector<GX2UniformBlock> pixelUBOs = std::vector<GX2UniformBlock>(pixelShader->uniformBlocks,
+                                                                              pixelShader->uniformBlocks + pixelShader->numUniformBlocks);
+
+        std::sort(pixelUBOs.begin(), pixelUBOs.end(), GX2UniformBlockComp);
+
+        for (u32 i = 0; i < pixelShader->numUniformBlocks; i++)
+        {
+            std::ostringstream formatOldStrm;
+            formatOldStrm << "layout(std430) readonly buffer CBUFFER_DATA_" << pixelUBOs[i].location << std::endl
+                          << "{" << std::endl
+                          << "    vec4 values[];" << std::endl
+                          << "}";
+
+            std::ostringstream formatNewStrm;
+            formatNewStrm << "layout(std140) uniform " << pixelUBOs[i].name << std::endl
+                          << "{" << std::endl
+                          << "    vec4 values[" << ((pixelUBOs[i].size + 15) / 16) << "];" << std::endl
+                          << "}";
+
+            ReplaceString(glFragmentShader, formatOldStrm.str(), formatNewStrm.str());
+        }
+    }
+
+    for (u32 i = 0; i < vertexShader->numSamplers; i++)
+    {
+        const GX2SamplerVar& sampler = vertexShader->samplerVars[i];
+        if (sampler.type != GX2_SAMPLER_TYPE_2D)
+            continue;
+
+        // Remove dummy 2D samplers definitions
+        {
+            std::ostringstream formatOldStrm;
+            formatOldStrm << "uniform sampler2D SPIRV_Cross_CombinedTEXTURE_"
+                          << sampler.location
+                          << "SPIRV_Cross_DummySampler;"
+                          << std::endl;
+
+            ReplaceString(glVertexShader, formatOldStrm.str(), "");
+        }
+        // Replace dummy 2D samplers
+        {
+            std::ostringstream formatOldStrm;
+            formatOldStrm << "SPIRV_Cross_CombinedTEXTURE_"
+                          << sampler.location
+                          << "SPIRV_Cross_DummySampler";
+
+            ReplaceString(glVertexShader, formatOldStrm.str(), sampler.name);
+        }
+        // Replace 2D samplers
+        {
+            std::ostringstream formatOldStrm;
+            formatOldStrm << "SPIRV_Cross_CombinedTEXTURE_"
+                          << sampler.location
+                          << "SAMPLER_"
+                          << sampler.location;
+
+            ReplaceString(glVertexShader, formatOldStrm.str(), sampler.name);
+        }
+    }
+
+    for (u32 i = 0; i < pixelShader->numSamplers; i++)
+    {
+        const GX2SamplerVar& sampler = pixelShader->samplerVars[i];
+        if (sampler.type != GX2_SAMPLER_TYPE_2D)
+            continue;
+
+        // Remove dummy 2D samplers definitions
+        {
+            std::ostringstream formatOldStrm;
+            formatOldStrm << "uniform sampler2D SPIRV_Cross_CombinedTEXTURE_"
+                          << sampler.location
+                          << "SPIRV_Cross_DummySampler;"
+                          << std::endl;
+
+            ReplaceString(glFragmentShader, formatOldStrm.str(), "");
+        }
+        // Replace dummy 2D samplers
+        {
+            std::ostringstream formatOldStrm;
+            formatOldStrm << "SPIRV_Cross_CombinedTEXTURE_"
+                          << sampler.location
+                          << "SPIRV_Cross_DummySampler";
+
+            ReplaceString(glFragmentShader, formatOldStrm.str(), sampler.name);
+        }
+        // Replace 2D samplers
+        {
+            std::ostringstream formatOldStrm;
+            formatOldStrm << "SPIRV_Cross_CombinedTEXTURE_"
+                          << sampler.location
+                          << "SAMPLER_"
+                          << sampler.location;
+
+            ReplaceString(glFragmentShader, formatOldStrm.str(), sampler.name);
+        }
+    }
+
+    static const std::array<std::string, 5> qualifiers = {
+        "noperspective centroid ",
+        "noperspective ",
+        "centroid ",
+        "sample ",
+        "flat "
+    };
+
+    for (u32 i = 0; i < 32; i++)
+    {
+        std::ostringstream layoutStrm;
+        layoutStrm << "layout(location = " << i << ") ";
+        const std::string& layoutStr = layoutStrm.str();
+
+        std::ostringstream paramVsOldStrm;
+        paramVsOldStrm << layoutStr << "out ";
+
+        for (const std::string& qualifier : qualifiers)
+        {
+            std::ostringstream paramFsStrm;
+            paramFsStrm << layoutStr << qualifier << "in ";
+
+            if (glFragmentShader.find(paramFsStrm.str()) != std::string::npos)
+            {
+                std::ostringstream paramVsNewStrm;
+                paramVsNewStrm << layoutStr << qualifier << "out ";
+
+                RIO_SHADER_DEBUG_LOG("Replacing \"%s\" with \"%s\"\n", paramVsOldStrm.str().c_str(), paramVsNewStrm.str().c_str());
+
+                ReplaceString(glVertexShader, paramVsOldStrm.str(), paramVsNewStrm.str());
+                break;
+            }
+        }
+    }
+
+    ReplaceString(glFragmentShader, "#version 410", "#version 430");
+    ReplaceString(glFragmentShader, "#extension GL_ARB_texture_query_levels : require\n", "");
+
+    ReplaceString(glFragmentShader, "uint needsPremultiply;",   "uint needsPremultiply; "
+                                                                "uint uItemID; "
+                                                                "int uIsSelected;");
+    ReplaceString(glFragmentShader, "int stackIdxVar;", "layout (location = 2) out uint ItemID;\n"
+                                                        "int stackIdxVar;");
+    ReplaceString(glFragmentShader, "PIXEL_0 = _pixelTmp;", "if (PS_PUSH.uIsSelected != 0) "
+                                                                "PIXEL_0 = vec4(_pixelTmp.rgb * 0.5f + vec3(1.0f, 0.25f, 0.25f) * 0.5f, _pixelTmp.a); "
+                                                            "else "
+                                                                "PIXEL_0 = _pixelTmp; "
+                                                            "ItemID = PS_PUSH.uItemID;");
+
+    return true;
+}
+
 struct ShaderCache
 {
     ShaderCache(const std::string& v, const std::string& f)
@@ -489,483 +949,558 @@ struct ShaderCache
     std::string fragmentShader;
 };
 typedef std::unordered_map<std::string, const ShaderCache> ShaderCacheMap;
-ShaderCacheMap sShaderCache;
 
-bool DecompileProgram(
-    const GX2VertexShader* vertexShader,
-    const GX2PixelShader* pixelShader,
-    std::string* vertexShaderSrc,
-    std::string* fragmentShaderSrc
-)
+// Decompiled programs, kept in memory and as one file per program in ShaderUtil::sTempPath.
+// An index file remembers the size and last use of every file so that the least recently used
+// ones can be evicted once the cache grows past ShaderUtil::sCacheSizeMax.
+class DecompileCache
 {
-    void* vertexShaderBuf;
-    size_t vertexShaderBufSize = SaveGX2VertexShader(vertexShader, &vertexShaderBuf);
-
-    void* pixelShaderBuf;
-    size_t pixelShaderBufSize = SaveGX2PixelShader(pixelShader, &pixelShaderBuf);
-
-    u8* shaderBuf = new u8[vertexShaderBufSize + pixelShaderBufSize];
-    std::memcpy(shaderBuf, vertexShaderBuf, vertexShaderBufSize);
-    std::memcpy(shaderBuf + vertexShaderBufSize, pixelShaderBuf, pixelShaderBufSize);
-
-    std::string key = md5(shaderBuf, vertexShaderBufSize + pixelShaderBufSize);
-
-    std::string glVertexShader;
-    std::string glFragmentShader;
-
-    ShaderCacheMap::const_iterator it = sShaderCache.find(key);
-    if (it != sShaderCache.end())
+public:
+    ~DecompileCache()
     {
-        RIO_SHADER_DEBUG_LOG("  Loading cache from map\n");
-        const ShaderCache& shaderCache = it->second;
-        glVertexShader = shaderCache.vertexShader;
-        glFragmentShader = shaderCache.fragmentShader;
+        flush();
     }
-    else
+
+    // Returns false if the program is not cached, in which case the caller must decompile it and call release().
+    // Blocks while another thread is decompiling or loading the same program.
+    // The files are read without holding the lock; the key stays in mPending meanwhile.
+    bool acquire(const std::string& key, std::string* vertexShader, std::string* fragmentShader)
     {
-        const std::string& basePath = ShaderUtil::sTempPath + '/' + key;
+        std::string directory;
+        bool indexed;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCond.wait(lock, [&]() { return mPending.count(key) == 0; });
 
-        const std::string& vertexShaderPath = basePath + "VS";
-        const std::string& fragmentShaderPath = basePath + "FS";
+            if (findMemory_(key, vertexShader, fragmentShader))
+                return true;
 
-        const std::string& vertexShaderSrcPath = vertexShaderPath + ".vert";
-        const std::string& fragmentShaderSrcPath = fragmentShaderPath + ".frag";
+            updateDirectory_();
 
-        if (FileExists(vertexShaderSrcPath.c_str()) && FileExists(fragmentShaderSrcPath.c_str()))
+            directory = mDirectory;
+            indexed = mIndex.count(key) != 0;
+            mPending.insert(key);
+        }
+
+        if (indexed)
         {
-            RIO_SHADER_DEBUG_LOG("  Loading cache from disk\n");
+            const bool valid = readEntry_(getEntryPath_(directory, key), vertexShader, fragmentShader);
             {
-                [[maybe_unused]] bool read = ReadFile(vertexShaderSrcPath, &glVertexShader);
-                RIO_ASSERT(read);
+                std::lock_guard<std::mutex> lock(mMutex);
+
+                if (valid)
+                {
+                    RIO_SHADER_DEBUG_LOG("  Loading cache from disk\n");
+                    mMemory.insert(ShaderCacheMap::value_type(key, ShaderCache(*vertexShader, *fragmentShader)));
+                    touch_(key);
+                    mPending.erase(key);
+                }
+                else if (directory == mDirectory)
+                {
+                    // Missing, stale or corrupted file: forget it and decompile again
+                    RIO_LOG("ShaderUtil: Dropping invalid cache entry %s\n", key.c_str());
+                    dropEntry_(key);
+                }
             }
+
+            if (valid)
             {
-                [[maybe_unused]] bool read = ReadFile(fragmentShaderSrcPath, &glFragmentShader);
-                RIO_ASSERT(read);
+                mCond.notify_all();
+                return true;
             }
         }
-        else
+        else if (readLegacyEntry_(directory, key, vertexShader, fragmentShader))
         {
-            const std::string& vertexShaderSpirvPath = vertexShaderSrcPath + ".spv";
-            const std::string& fragmentShaderSpirvPath = fragmentShaderSrcPath + ".spv";
+            RIO_SHADER_DEBUG_LOG("  Loading legacy cache from disk\n");
+            release(key, vertexShader, fragmentShader);
+            return true;
+        }
 
-            RIO_SHADER_DEBUG_LOG("\n");
-            RIO_SHADER_DEBUG_LOG("%s\n", vertexShaderSpirvPath.c_str());
-            RIO_SHADER_DEBUG_LOG("%s\n", fragmentShaderSpirvPath.c_str());
+        // Still pending, until the caller calls release()
+        return false;
+    }
 
-            WriteFile(vertexShaderPath.c_str(), (u8*)vertexShaderBuf, vertexShaderBufSize);
-            WriteFile(fragmentShaderPath.c_str(), (u8*)pixelShaderBuf, pixelShaderBufSize);
+    // vertexShader and fragmentShader are null if decompiling failed
+    void release(const std::string& key, const std::string* vertexShader, const std::string* fragmentShader)
+    {
+        std::string directory;
+        if (vertexShader && fragmentShader)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
 
-            std::string cmd;
-            {
-                std::ostringstream cmdStrm;
-                cmdStrm << "\"" << ShaderUtil::sGx2ShaderDecompilerPath << "\" -v \"" << vertexShaderPath << "\" -p \"" << fragmentShaderPath << "\"";
-                cmd = cmdStrm.str();
-            }
-            RIO_SHADER_DEBUG_LOG("%s\n", cmd.c_str());
-            RunCommand(cmd.c_str());
+            mMemory.insert(ShaderCacheMap::value_type(key, ShaderCache(*vertexShader, *fragmentShader)));
 
-            DeleteFile(vertexShaderPath.c_str());
-            DeleteFile(fragmentShaderPath.c_str());
+            updateDirectory_();
+            directory = mDirectory;
+        }
 
-            if (!FileExists(vertexShaderSpirvPath.c_str()))
-                return false;
+        // The key is still in mPending, so no other thread touches its file meanwhile
+        const u64 size = vertexShader && fragmentShader && !directory.empty()
+            ? writeEntry_(getEntryPath_(directory, key), *vertexShader, *fragmentShader)
+            : 0;
 
-            if (!FileExists(fragmentShaderSpirvPath.c_str()))
-                return false;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
 
+            // The index is only saved by flush()
+            if (size != 0 && directory == mDirectory)
             {
-                std::ostringstream cmdStrm;
-                cmdStrm << "\"" << ShaderUtil::sSpirvCrossPath << "\" \"" << vertexShaderSpirvPath << "\" --no-es "  \
-                    "--no-420pack-extension --no-support-nonzero-baseinstance " \
-                    "--rename-interface-variable out 0 PARAM_0 " \
-                    "--rename-interface-variable out 1 PARAM_1 " \
-                    "--rename-interface-variable out 2 PARAM_2 " \
-                    "--rename-interface-variable out 3 PARAM_3 " \
-                    "--rename-interface-variable out 4 PARAM_4 " \
-                    "--rename-interface-variable out 5 PARAM_5 " \
-                    "--rename-interface-variable out 6 PARAM_6 " \
-                    "--rename-interface-variable out 7 PARAM_7 " \
-                    "--rename-interface-variable out 8 PARAM_8 " \
-                    "--rename-interface-variable out 9 PARAM_9 " \
-                    "--rename-interface-variable out 10 PARAM_10 " \
-                    "--rename-interface-variable out 11 PARAM_11 " \
-                    "--rename-interface-variable out 12 PARAM_12 " \
-                    "--rename-interface-variable out 13 PARAM_13 " \
-                    "--rename-interface-variable out 14 PARAM_14 " \
-                    "--rename-interface-variable out 15 PARAM_15 " \
-                    "--rename-interface-variable out 16 PARAM_16 " \
-                    "--rename-interface-variable out 17 PARAM_17 " \
-                    "--rename-interface-variable out 18 PARAM_18 " \
-                    "--rename-interface-variable out 19 PARAM_19 " \
-                    "--rename-interface-variable out 20 PARAM_20 " \
-                    "--rename-interface-variable out 21 PARAM_21 " \
-                    "--rename-interface-variable out 22 PARAM_22 " \
-                    "--rename-interface-variable out 23 PARAM_23 " \
-                    "--rename-interface-variable out 24 PARAM_24 " \
-                    "--rename-interface-variable out 25 PARAM_25 " \
-                    "--rename-interface-variable out 26 PARAM_26 " \
-                    "--rename-interface-variable out 27 PARAM_27 " \
-                    "--rename-interface-variable out 28 PARAM_28 " \
-                    "--rename-interface-variable out 29 PARAM_29 " \
-                    "--rename-interface-variable out 30 PARAM_30 " \
-                    "--rename-interface-variable out 31 PARAM_31 " \
-                    "--rename-interface-variable out 32 PARAM_32 " \
-                    "--rename-interface-variable out 33 PARAM_33 " \
-                    "--rename-interface-variable out 34 PARAM_34 " \
-                    "--rename-interface-variable out 35 PARAM_35 " \
-                    "--rename-interface-variable out 36 PARAM_36 " \
-                    "--rename-interface-variable out 37 PARAM_37 " \
-                    "--rename-interface-variable out 38 PARAM_38 " \
-                    "--rename-interface-variable out 39 PARAM_39 " \
-                    "--rename-interface-variable out 40 PARAM_40 " \
-                    "--rename-interface-variable out 41 PARAM_41 " \
-                    "--rename-interface-variable out 42 PARAM_42 " \
-                    "--rename-interface-variable out 43 PARAM_43 " \
-                    "--rename-interface-variable out 44 PARAM_44 " \
-                    "--rename-interface-variable out 45 PARAM_45 " \
-                    "--rename-interface-variable out 46 PARAM_46 " \
-                    "--rename-interface-variable out 47 PARAM_47 " \
-                    "--rename-interface-variable out 48 PARAM_48 " \
-                    "--rename-interface-variable out 49 PARAM_49 " \
-                    "--rename-interface-variable out 50 PARAM_50 " \
-                    "--rename-interface-variable out 51 PARAM_51 " \
-                    "--rename-interface-variable out 52 PARAM_52 " \
-                    "--rename-interface-variable out 53 PARAM_53 " \
-                    "--rename-interface-variable out 54 PARAM_54 " \
-                    "--rename-interface-variable out 55 PARAM_55 " \
-                    "--rename-interface-variable out 56 PARAM_56 " \
-                    "--rename-interface-variable out 57 PARAM_57 " \
-                    "--rename-interface-variable out 58 PARAM_58 " \
-                    "--rename-interface-variable out 59 PARAM_59 " \
-                    "--rename-interface-variable out 60 PARAM_60 " \
-                    "--rename-interface-variable out 61 PARAM_61 " \
-                    "--rename-interface-variable out 62 PARAM_62 " \
-                    "--rename-interface-variable out 63 PARAM_63 " \
-                    "--version 410 --output \"" << vertexShaderSrcPath << "\"";
-                cmd = cmdStrm.str();
+                Entry& entry = mIndex[key];
+                mTotalSize -= entry.size;
+                mTotalSize += size;
+                entry.size = size;
+                entry.lastUse = ++mUseCounter;
+                mIndexDirty = true;
+
+                evict_();
             }
-            RIO_SHADER_DEBUG_LOG("%s\n", cmd.c_str());
-            RunCommand(cmd.c_str());
 
-            DeleteFile(vertexShaderSpirvPath.c_str());
-            if (!FileExists(vertexShaderSrcPath.c_str()))
-                return false;
+            mPending.erase(key);
+        }
+        mCond.notify_all();
+    }
 
-            {
-                std::ostringstream cmdStrm;
-                cmdStrm << "\"" << ShaderUtil::sSpirvCrossPath << "\" \"" << fragmentShaderSpirvPath << "\" --no-es "  \
-                    "--no-420pack-extension --no-support-nonzero-baseinstance " \
-                    "--rename-interface-variable in 0 PARAM_0 " \
-                    "--rename-interface-variable in 1 PARAM_1 " \
-                    "--rename-interface-variable in 2 PARAM_2 " \
-                    "--rename-interface-variable in 3 PARAM_3 " \
-                    "--rename-interface-variable in 4 PARAM_4 " \
-                    "--rename-interface-variable in 5 PARAM_5 " \
-                    "--rename-interface-variable in 6 PARAM_6 " \
-                    "--rename-interface-variable in 7 PARAM_7 " \
-                    "--rename-interface-variable in 8 PARAM_8 " \
-                    "--rename-interface-variable in 9 PARAM_9 " \
-                    "--rename-interface-variable in 10 PARAM_10 " \
-                    "--rename-interface-variable in 11 PARAM_11 " \
-                    "--rename-interface-variable in 12 PARAM_12 " \
-                    "--rename-interface-variable in 13 PARAM_13 " \
-                    "--rename-interface-variable in 14 PARAM_14 " \
-                    "--rename-interface-variable in 15 PARAM_15 " \
-                    "--rename-interface-variable in 16 PARAM_16 " \
-                    "--rename-interface-variable in 17 PARAM_17 " \
-                    "--rename-interface-variable in 18 PARAM_18 " \
-                    "--rename-interface-variable in 19 PARAM_19 " \
-                    "--rename-interface-variable in 20 PARAM_20 " \
-                    "--rename-interface-variable in 21 PARAM_21 " \
-                    "--rename-interface-variable in 22 PARAM_22 " \
-                    "--rename-interface-variable in 23 PARAM_23 " \
-                    "--rename-interface-variable in 24 PARAM_24 " \
-                    "--rename-interface-variable in 25 PARAM_25 " \
-                    "--rename-interface-variable in 26 PARAM_26 " \
-                    "--rename-interface-variable in 27 PARAM_27 " \
-                    "--rename-interface-variable in 28 PARAM_28 " \
-                    "--rename-interface-variable in 29 PARAM_29 " \
-                    "--rename-interface-variable in 30 PARAM_30 " \
-                    "--rename-interface-variable in 31 PARAM_31 " \
-                    "--rename-interface-variable in 32 PARAM_32 " \
-                    "--rename-interface-variable in 33 PARAM_33 " \
-                    "--rename-interface-variable in 34 PARAM_34 " \
-                    "--rename-interface-variable in 35 PARAM_35 " \
-                    "--rename-interface-variable in 36 PARAM_36 " \
-                    "--rename-interface-variable in 37 PARAM_37 " \
-                    "--rename-interface-variable in 38 PARAM_38 " \
-                    "--rename-interface-variable in 39 PARAM_39 " \
-                    "--rename-interface-variable in 40 PARAM_40 " \
-                    "--rename-interface-variable in 41 PARAM_41 " \
-                    "--rename-interface-variable in 42 PARAM_42 " \
-                    "--rename-interface-variable in 43 PARAM_43 " \
-                    "--rename-interface-variable in 44 PARAM_44 " \
-                    "--rename-interface-variable in 45 PARAM_45 " \
-                    "--rename-interface-variable in 46 PARAM_46 " \
-                    "--rename-interface-variable in 47 PARAM_47 " \
-                    "--rename-interface-variable in 48 PARAM_48 " \
-                    "--rename-interface-variable in 49 PARAM_49 " \
-                    "--rename-interface-variable in 50 PARAM_50 " \
-                    "--rename-interface-variable in 51 PARAM_51 " \
-                    "--rename-interface-variable in 52 PARAM_52 " \
-                    "--rename-interface-variable in 53 PARAM_53 " \
-                    "--rename-interface-variable in 54 PARAM_54 " \
-                    "--rename-interface-variable in 55 PARAM_55 " \
-                    "--rename-interface-variable in 56 PARAM_56 " \
-                    "--rename-interface-variable in 57 PARAM_57 " \
-                    "--rename-interface-variable in 58 PARAM_58 " \
-                    "--rename-interface-variable in 59 PARAM_59 " \
-                    "--rename-interface-variable in 60 PARAM_60 " \
-                    "--rename-interface-variable in 61 PARAM_61 " \
-                    "--rename-interface-variable in 62 PARAM_62 " \
-                    "--rename-interface-variable in 63 PARAM_63 " \
-                    "--version 410 --output \"" << fragmentShaderSrcPath << "\"";
-                cmd = cmdStrm.str();
-            }
-            RIO_SHADER_DEBUG_LOG("%s\n", cmd.c_str());
-            RunCommand(cmd.c_str());
+    void flush()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
 
-            DeleteFile(fragmentShaderSpirvPath.c_str());
-            if (!FileExists(fragmentShaderSrcPath.c_str()))
-                return false;
+        if (mIndexDirty)
+            saveIndex_();
+    }
 
+private:
+    struct Entry
+    {
+        u64 size;
+        u64 lastUse;
+    };
+
+    struct FileHeader
+    {
+        u32 magic;
+        u32 version;
+        u32 vertexShaderSize;
+        u32 fragmentShaderSize;
+        u32 vertexShaderHash;
+        u32 fragmentShaderHash;
+    };
+
+    static constexpr u32 cFileMagic = 0x45435352; // "RSCE"
+    static constexpr u32 cFileVersion = 1;
+    static constexpr const char* cIndexHeader = "RIO_SHADER_CACHE 1";
+
+    static std::string getEntryPath_(const std::string& directory, const std::string& key)
+    {
+        return directory + '/' + key + ".glsl";
+    }
+
+    std::string getIndexPath_() const
+    {
+        return mDirectory + "/ShaderCache.idx";
+    }
+
+    bool findMemory_(const std::string& key, std::string* vertexShader, std::string* fragmentShader)
+    {
+        ShaderCacheMap::const_iterator it = mMemory.find(key);
+        if (it == mMemory.end())
+            return false;
+
+        RIO_SHADER_DEBUG_LOG("  Loading cache from map\n");
+        *vertexShader = it->second.vertexShader;
+        *fragmentShader = it->second.fragmentShader;
+        touch_(key);
+        return true;
+    }
+
+    void touch_(const std::string& key)
+    {
+        std::unordered_map<std::string, Entry>::iterator it = mIndex.find(key);
+        if (it == mIndex.end())
+            return;
+
+        it->second.lastUse = ++mUseCounter;
+        mIndexDirty = true;
+    }
+
+    void dropEntry_(const std::string& key)
+    {
+        std::unordered_map<std::string, Entry>::iterator it = mIndex.find(key);
+        if (it == mIndex.end())
+            return;
+
+        RemoveFile(getEntryPath_(mDirectory, key).c_str());
+        mTotalSize -= it->second.size;
+        mIndex.erase(it);
+        mIndexDirty = true;
+    }
+
+    static bool readEntry_(const std::string& path, std::string* vertexShader, std::string* fragmentShader)
+    {
+        std::ifstream inf(path, std::ifstream::in | std::ifstream::binary);
+
+        FileHeader header;
+        bool valid = inf && inf.read((char*)&header, sizeof(FileHeader)) &&
+                     header.magic == cFileMagic && header.version == cFileVersion;
+
+        if (valid)
+        {
+            vertexShader->resize(header.vertexShaderSize);
+            fragmentShader->resize(header.fragmentShaderSize);
+
+            valid = inf.read(vertexShader->data(), header.vertexShaderSize) &&
+                    inf.read(fragmentShader->data(), header.fragmentShaderSize) &&
+                    HashCRC32::calcHash(vertexShader->data(), header.vertexShaderSize) == header.vertexShaderHash &&
+                    HashCRC32::calcHash(fragmentShader->data(), header.fragmentShaderSize) == header.fragmentShaderHash;
+        }
+
+        return valid;
+    }
+
+    // Files of previous versions, stored as <key>VS.vert and <key>FS.frag with the null terminator
+    static bool readLegacyEntry_(const std::string& directory, const std::string& key, std::string* vertexShader, std::string* fragmentShader)
+    {
+        const std::string& vertexShaderSrcPath = directory + '/' + key + "VS.vert";
+        const std::string& fragmentShaderSrcPath = directory + '/' + key + "FS.frag";
+
+        if (!FileExists(vertexShaderSrcPath.c_str()) || !FileExists(fragmentShaderSrcPath.c_str()))
+            return false;
+
+        if (!ReadFile(vertexShaderSrcPath, vertexShader) || !ReadFile(fragmentShaderSrcPath, fragmentShader))
+            return false;
+
+        if (!vertexShader->empty() && vertexShader->back() == '\0')
+            vertexShader->pop_back();
+
+        if (!fragmentShader->empty() && fragmentShader->back() == '\0')
+            fragmentShader->pop_back();
+
+        RemoveFile(vertexShaderSrcPath.c_str());
+        RemoveFile(fragmentShaderSrcPath.c_str());
+        return true;
+    }
+
+    static u64 writeEntry_(const std::string& path, const std::string& vertexShader, const std::string& fragmentShader)
+    {
+        const std::string& tempPath = path + ".tmp";
+
+        FileHeader header;
+        header.magic = cFileMagic;
+        header.version = cFileVersion;
+        header.vertexShaderSize = vertexShader.size();
+        header.fragmentShaderSize = fragmentShader.size();
+        header.vertexShaderHash = HashCRC32::calcHash(vertexShader.data(), vertexShader.size());
+        header.fragmentShaderHash = HashCRC32::calcHash(fragmentShader.data(), fragmentShader.size());
+
+        {
+            std::ofstream outf(tempPath, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+            outf.write((const char*)&header, sizeof(FileHeader));
+            outf.write(vertexShader.data(), vertexShader.size());
+            outf.write(fragmentShader.data(), fragmentShader.size());
+
+            if (!outf.flush())
             {
-                [[maybe_unused]] bool read = ReadFile(vertexShaderSrcPath, &glVertexShader);
-                RIO_ASSERT(read);
+                outf.close();
+                RemoveFile(tempPath.c_str());
+                return 0;
             }
-            DeleteFile(vertexShaderSrcPath.c_str());
+        }
+
+        if (!ReplaceFile(tempPath, path))
+            return 0;
+
+        return sizeof(FileHeader) + vertexShader.size() + fragmentShader.size();
+    }
+
+    void evict_()
+    {
+        const u64 sizeMax = ShaderUtil::sCacheSizeMax;
+        if (sizeMax == 0 || mTotalSize <= sizeMax)
+            return;
+
+        std::vector<std::pair<u64, std::string>> lru;
+        lru.reserve(mIndex.size());
+        for (const auto& it : mIndex)
+            lru.emplace_back(it.second.lastUse, it.first);
+
+        std::sort(lru.begin(), lru.end());
+
+        // Always keep the most recently used entry, even if it alone is over the limit
+        for (size_t i = 0; i + 1 < lru.size() && mTotalSize > sizeMax; i++)
+        {
+            const std::string& key = lru[i].second;
 
+            RemoveFile(getEntryPath_(mDirectory, key).c_str());
+            mTotalSize -= mIndex[key].size;
+            mIndex.erase(key);
+            mMemory.erase(key);
+        }
+
+        mIndexDirty = true;
+    }
+
+    // Reloads the index if ShaderUtil::sTempPath changed since the last call
+    void updateDirectory_()
+    {
+        if (mDirectory == ShaderUtil::sTempPath)
+            return;
+
+        if (mIndexDirty)
+            saveIndex_();
+
+        mDirectory = ShaderUtil::sTempPath;
+        mIndex.clear();
+        mTotalSize = 0;
+        mUseCounter = 0;
+        mIndexDirty = false;
+
+        std::ifstream inf(getIndexPath_(), std::ifstream::in);
+
+        std::string line;
+        if (!std::getline(inf, line) || line != cIndexHeader)
+            return;
+
+        std::string key;
+        Entry entry;
+        while (inf >> key >> entry.size >> entry.lastUse)
+        {
+            mIndex[key] = entry;
+            mTotalSize += entry.size;
+            mUseCounter = std::max(mUseCounter, entry.lastUse);
+        }
+    }
+
+    void saveIndex_()
+    {
+        if (mDirectory.empty())
+            return;
+
+        const std::string& path = getIndexPath_();
+        const std::string& tempPath = path + ".tmp";
+
+        {
+            std::ofstream outf(tempPath, std::ofstream::out | std::ofstream::trunc);
+            outf << cIndexHeader << '\n';
+            for (const auto& it : mIndex)
+                outf << it.first << ' ' << it.second.size << ' ' << it.second.lastUse << '\n';
+
+            if (!outf.flush())
             {
-                [[maybe_unused]] bool read = ReadFile(fragmentShaderSrcPath, &glFragmentShader);
-                RIO_ASSERT(read);
+                outf.close();
+                RemoveFile(tempPath.c_str());
+                return;
             }
-            DeleteFile(fragmentShaderSrcPath.c_str());
+        }
 
-            ReplaceString(glVertexShader, "\r\n", "\n");
-            ReplaceString(glFragmentShader, "\r\n", "\n");
+        if (ReplaceFile(tempPath, path))
+            mIndexDirty = false;
+    }
 
-            RIO_ASSERT(vertexShader->shaderMode == GX2_SHADER_MODE_UNIFORM_REGISTERS || vertexShader->shaderMode == GX2_SHADER_MODE_UNIFORM_BLOCKS);
+private:
+    std::mutex mMutex;
+    std::condition_variable mCond;
+    std::unordered_set<std::string> mPending;
+    ShaderCacheMap mMemory;
+    std::unordered_map<std::string, Entry> mIndex;
+    std::string mDirectory;
+    u64 mTotalSize = 0;
+    u64 mUseCounter = 0;
+    bool mIndexDirty = false;
+};
+DecompileCache sDecompileCache;
 
-            RIO_SHADER_DEBUG_LOG("Vertex shader mode: %u\n", u32(vertexShader->shaderMode));
+// The key is built from field values in a fixed little-endian encoding, never from raw structs,
+// so that it does not depend on pointer size, padding or host byte order.
+void HashU32(Hash128& hash, u32 value)
+{
+    const u8 bytes[4] = { u8(value), u8(value >> 8), u8(value >> 16), u8(value >> 24) };
+    hash.update(bytes, sizeof(bytes));
+}
 
-            if (vertexShader->shaderMode == GX2_SHADER_MODE_UNIFORM_REGISTERS)
-            {
-                const std::string& formatOldStr = "layout(std430) readonly buffer CFILE_DATA";
-                const std::string& formatNewStr = "layout(std140) uniform VS_CFILE_DATA";
+void HashF32(Hash128& hash, f32 value)
+{
+    u32 bits;
+    std::memcpy(&bits, &value, sizeof(u32));
+    HashU32(hash, bits);
+}
 
-                ReplaceString(glVertexShader, formatOldStr, formatNewStr);
-            }
-            else
-            {
-                std::vector<GX2UniformBlock> vertexUBOs = std::vector<GX2UniformBlock>(vertexShader->uniformBlocks,
-                                                                                       vertexShader->uniformBlocks + vertexShader->numUniformBlocks);
+void HashName(Hash128& hash, const char* name)
+{
+    if (name != NULL)
+        hash.update(name, std::strlen(name) + 1);
+    else
+        hash.update("", 1);
+}
 
-                std::sort(vertexUBOs.begin(), vertexUBOs.end(), GX2UniformBlockComp);
+void HashVar(Hash128& hash, const GX2UniformBlock& var)
+{
+    HashName(hash, var.name);
+    HashU32(hash, var.offset);
+    HashU32(hash, var.size);
+}
 
-                for (u32 i = 0; i < vertexShader->numUniformBlocks; i++)
-                {
-                    std::ostringstream formatOldStrm;
-                    formatOldStrm << "layout(std430) readonly buffer CBUFFER_DATA_" << vertexUBOs[i].location << std::endl
-                                  << "{" << std::endl
-                                  << "    vec4 values[];" << std::endl
-                                  << "}";
-
-                    std::ostringstream formatNewStrm;
-                    formatNewStrm << "layout(std140) uniform " << vertexUBOs[i].name << std::endl
-                                  << "{" << std::endl
-                                  << "    vec4 values[" << ((vertexUBOs[i].size + 15) / 16) << "];" << std::endl
-                                  << "}";
-
-                    ReplaceString(glVertexShader, formatOldStrm.str(), formatNewStrm.str());
-                }
-            }
+void HashVar(Hash128& hash, const GX2UniformVar& var)
+{
+    HashName(hash, var.name);
+    HashU32(hash, var.type);
+    HashU32(hash, var.count);
+    HashU32(hash, var.offset);
+    HashU32(hash, var.blockIndex);
+}
 
-            RIO_ASSERT(pixelShader->shaderMode == GX2_SHADER_MODE_UNIFORM_REGISTERS || pixelShader->shaderMode == GX2_SHADER_MODE_UNIFORM_BLOCKS);
+void HashVar(Hash128& hash, const GX2SamplerVar& var)
+{
+    HashName(hash, var.name);
+    HashU32(hash, var.type);
+    HashU32(hash, var.location);
+}
 
-            RIO_SHADER_DEBUG_LOG("Pixel shader mode: %u\n", u32(pixelShader->shaderMode));
+void HashVar(Hash128& hash, const GX2AttribVar& var)
+{
+    HashName(hash, var.name);
+    HashU32(hash, var.type);
+    HashU32(hash, var.count);
+    HashU32(hash, var.location);
+}
 
-            if (pixelShader->shaderMode == GX2_SHADER_MODE_UNIFORM_REGISTERS)
-            {
-                const std::string& formatOldStr = "layout(std430) readonly buffer CFILE_DATA";
-                const std::string& formatNewStr = "layout(std140) uniform PS_CFILE_DATA";
+template <typename T>
+void HashVarTable(Hash128& hash, const T* vars, u32 num)
+{
+    HashU32(hash, num);
 
-                ReplaceString(glFragmentShader, formatOldStr, formatNewStr);
-            }
-            else
-            {
-                std::vector<GX2UniformBlock> pixelUBOs = std::vector<GX2UniformBlock>(pixelShader->uniformBlocks,
-                                                                                      pixelShader->uniformBlocks + pixelShader->numUniformBlocks);
+    for (u32 i = 0; i < num; i++)
+        HashVar(hash, vars[i]);
+}
 
-                std::sort(pixelUBOs.begin(), pixelUBOs.end(), GX2UniformBlockComp);
+// Hashes what the decompiler reads: the registers, the mode, the variable tables, the initial values, the loop vars and the program code
+template <typename T>
+void HashGX2Shader(Hash128& hash, const T* shader)
+{
+    // The registers are the u32 words preceding shaderSize
+    static_assert(offsetof(T, shaderSize) % sizeof(u32) == 0);
+    const u32* regs = reinterpret_cast<const u32*>(shader);
+    for (size_t i = 0; i < offsetof(T, shaderSize) / sizeof(u32); i++)
+        HashU32(hash, regs[i]);
 
-                for (u32 i = 0; i < pixelShader->numUniformBlocks; i++)
-                {
-                    std::ostringstream formatOldStrm;
-                    formatOldStrm << "layout(std430) readonly buffer CBUFFER_DATA_" << pixelUBOs[i].location << std::endl
-                                  << "{" << std::endl
-                                  << "    vec4 values[];" << std::endl
-                                  << "}";
-
-                    std::ostringstream formatNewStrm;
-                    formatNewStrm << "layout(std140) uniform " << pixelUBOs[i].name << std::endl
-                                  << "{" << std::endl
-                                  << "    vec4 values[" << ((pixelUBOs[i].size + 15) / 16) << "];" << std::endl
-                                  << "}";
-
-                    ReplaceString(glFragmentShader, formatOldStrm.str(), formatNewStrm.str());
-                }
-            }
+    HashU32(hash, shader->shaderMode);
 
-            for (u32 i = 0; i < vertexShader->numSamplers; i++)
-            {
-                const GX2SamplerVar& sampler = vertexShader->samplerVars[i];
-                if (sampler.type != GX2_SAMPLER_TYPE_2D)
-                    continue;
+    HashVarTable(hash, shader->uniformBlocks, shader->numUniformBlocks);
+    HashVarTable(hash, shader->uniformVars, shader->numUniforms);
+    HashVarTable(hash, shader->samplerVars, shader->numSamplers);
 
-                // Remove dummy 2D samplers definitions
-                {
-                    std::ostringstream formatOldStrm;
-                    formatOldStrm << "uniform sampler2D SPIRV_Cross_CombinedTEXTURE_"
-                                  << sampler.location
-                                  << "SPIRV_Cross_DummySampler;"
-                                  << std::endl;
+    HashU32(hash, shader->numInitialValues);
+    for (u32 i = 0; i < shader->numInitialValues; i++)
+    {
+        const GX2UniformInitialValue& value = shader->initialValues[i];
+        for (u32 j = 0; j < 4; j++)
+            HashF32(hash, value.value[j]);
 
-                    ReplaceString(glVertexShader, formatOldStrm.str(), "");
-                }
-                // Replace dummy 2D samplers
-                {
-                    std::ostringstream formatOldStrm;
-                    formatOldStrm << "SPIRV_Cross_CombinedTEXTURE_"
-                                  << sampler.location
-                                  << "SPIRV_Cross_DummySampler";
+        HashU32(hash, value.offset);
+    }
 
-                    ReplaceString(glVertexShader, formatOldStrm.str(), sampler.name);
-                }
-                // Replace 2D samplers
-                {
-                    std::ostringstream formatOldStrm;
-                    formatOldStrm << "SPIRV_Cross_CombinedTEXTURE_"
-                                  << sampler.location
-                                  << "SAMPLER_"
-                                  << sampler.location;
+    const u32* loopVars = static_cast<const u32*>(shader->_loopVars);
+    HashU32(hash, shader->_numLoops);
+    for (u32 i = 0; i < shader->_numLoops * 2; i++)
+        HashU32(hash, loopVars[i]);
 
-                    ReplaceString(glVertexShader, formatOldStrm.str(), sampler.name);
-                }
-            }
+    HashU32(hash, shader->shaderSize);
+    hash.update(shader->shaderPtr, shader->shaderSize);
+}
 
-            for (u32 i = 0; i < pixelShader->numSamplers; i++)
-            {
-                const GX2SamplerVar& sampler = pixelShader->samplerVars[i];
-                if (sampler.type != GX2_SAMPLER_TYPE_2D)
-                    continue;
+// Key of the program, computed from the shaders in place
+std::string CalcProgramKey(const GX2VertexShader* vertexShader, const GX2PixelShader* pixelShader)
+{
+    Hash128 hash;
 
-                // Remove dummy 2D samplers definitions
-                {
-                    std::ostringstream formatOldStrm;
-                    formatOldStrm << "uniform sampler2D SPIRV_Cross_CombinedTEXTURE_"
-                                  << sampler.location
-                                  << "SPIRV_Cross_DummySampler;"
-                                  << std::endl;
+    HashGX2Shader(hash, vertexShader);
+    HashVarTable(hash, vertexShader->attribVars, vertexShader->numAttribs);
 
-                    ReplaceString(glFragmentShader, formatOldStrm.str(), "");
-                }
-                // Replace dummy 2D samplers
-                {
-                    std::ostringstream formatOldStrm;
-                    formatOldStrm << "SPIRV_Cross_CombinedTEXTURE_"
-                                  << sampler.location
-                                  << "SPIRV_Cross_DummySampler";
+    HashGX2Shader(hash, pixelShader);
 
-                    ReplaceString(glFragmentShader, formatOldStrm.str(), sampler.name);
-                }
-                // Replace 2D samplers
-                {
-                    std::ostringstream formatOldStrm;
-                    formatOldStrm << "SPIRV_Cross_CombinedTEXTURE_"
-                                  << sampler.location
-                                  << "SAMPLER_"
-                                  << sampler.location;
+    return hash.hexdigest();
+}
 
-                    ReplaceString(glFragmentShader, formatOldStrm.str(), sampler.name);
-                }
-            }
+bool DecompileProgram(
+    const GX2VertexShader* vertexShader,
+    const GX2PixelShader* pixelShader,
+    std::string* vertexShaderSrc,
+    std::string* fragmentShaderSrc
+)
+{
+    // The serialized shaders are only needed by the decompiler, or to compute MD5 keys
+    void* vertexShaderBuf = nullptr;
+    size_t vertexShaderBufSize = 0;
 
-            static const std::array<std::string, 5> qualifiers = {
-                "noperspective centroid ",
-                "noperspective ",
-                "centroid ",
-                "sample ",
-                "flat "
-            };
+    void* pixelShaderBuf = nullptr;
+    size_t pixelShaderBufSize = 0;
 
-            for (u32 i = 0; i < 32; i++)
-            {
-                std::ostringstream layoutStrm;
-                layoutStrm << "layout(location = " << i << ") ";
-                const std::string& layoutStr = layoutStrm.str();
+    std::string key;
 
-                std::ostringstream paramVsOldStrm;
-                paramVsOldStrm << layoutStr << "out ";
+    if (ShaderUtil::sUseMD5Key)
+    {
+        vertexShaderBufSize = SaveGX2VertexShader(vertexShader, &vertexShaderBuf);
+        pixelShaderBufSize = SaveGX2PixelShader(pixelShader, &pixelShaderBuf);
 
-                for (const std::string& qualifier : qualifiers)
-                {
-                    std::ostringstream paramFsStrm;
-                    paramFsStrm << layoutStr << qualifier << "in ";
+        MD5 md5;
+        md5.update((const char*)vertexShaderBuf, vertexShaderBufSize);
+        md5.update((const char*)pixelShaderBuf, pixelShaderBufSize);
+        md5.finalize();
 
-                    if (glFragmentShader.find(paramFsStrm.str()) != std::string::npos)
-                    {
-                        std::ostringstream paramVsNewStrm;
-                        paramVsNewStrm << layoutStr << qualifier << "out ";
+        key = md5.hexdigest();
+    }
+    else
+    {
+        key = CalcProgramKey(vertexShader, pixelShader);
+    }
 
-                        RIO_SHADER_DEBUG_LOG("Replacing \"%s\" with \"%s\"\n", paramVsOldStrm.str().c_str(), paramVsNewStrm.str().c_str());
+    std::string glVertexShader;
+    std::string glFragmentShader;
 
-                        ReplaceString(glVertexShader, paramVsOldStrm.str(), paramVsNewStrm.str());
-                        break;
-                    }
-                }
-            }
+    bool ret = true;
 
-            ReplaceString(glFragmentShader, "#version 410", "#version 430");
-            ReplaceString(glFragmentShader, "#extension GL_ARB_texture_query_levels : require\n", "");
-
-            ReplaceString(glFragmentShader, "uint needsPremultiply;",   "uint needsPremultiply; "
-                                                                        "uint uItemID; "
-                                                                        "int uIsSelected;");
-            ReplaceString(glFragmentShader, "int stackIdxVar;", "layout (location = 2) out uint ItemID;\n"
-                                                                "int stackIdxVar;");
-            ReplaceString(glFragmentShader, "PIXEL_0 = _pixelTmp;", "if (PS_PUSH.uIsSelected != 0) "
-                                                                        "PIXEL_0 = vec4(_pixelTmp.rgb * 0.5f + vec3(1.0f, 0.25f, 0.25f) * 0.5f, _pixelTmp.a); "
-                                                                    "else "
-                                                                        "PIXEL_0 = _pixelTmp; "
-                                                                    "ItemID = PS_PUSH.uItemID;");
-
-            WriteFile(vertexShaderSrcPath, glVertexShader);
-            WriteFile(fragmentShaderSrcPath, glFragmentShader);
+    if (!sDecompileCache.acquire(key, &glVertexShader, &glFragmentShader))
+    {
+        if (!vertexShaderBuf)
+        {
+            vertexShaderBufSize = SaveGX2VertexShader(vertexShader, &vertexShaderBuf);
+            pixelShaderBufSize = SaveGX2PixelShader(pixelShader, &pixelShaderBuf);
         }
 
-        sShaderCache.insert(ShaderCacheMap::value_type(key, ShaderCache(glVertexShader, glFragmentShader)));
+        ret = RunDecompiler(
+            key,
+            vertexShader, pixelShader,
+            vertexShaderBuf, vertexShaderBufSize,
+            pixelShaderBuf, pixelShaderBufSize,
+            glVertexShader, glFragmentShader
+        );
+
+        if (ret)
+            sDecompileCache.release(key, &glVertexShader, &glFragmentShader);
+        else
+            sDecompileCache.release(key, nullptr, nullptr);
     }
 
-    rio::MemUtil::free(vertexShaderBuf);
-    rio::MemUtil::free(pixelShaderBuf);
-    delete[] shaderBuf;
+    if (vertexShaderBuf)
+    {
+        rio::MemUtil::free(vertexShaderBuf);
+        rio::MemUtil::free(pixelShaderBuf);
+    }
+
+    if (!ret)
+        return false;
 
     *vertexShaderSrc = glVertexShader;
     *fragmentShaderSrc = glFragmentShader;
     return true;
 }
-
 }
 
 std::string ShaderUtil::sTempPath = "";
 std::string ShaderUtil::sGx2ShaderDecompilerPath = "";
 std::string ShaderUtil::sSpirvCrossPath = "";
+u64 ShaderUtil::sCacheSizeMax = 256 * 1024 * 1024;
+bool ShaderUtil::sUseMD5Key = false;
 
-bool ShaderUtil::decompileGsh(
-    const GX2VertexShader& vertex_shader,
-    const GX2PixelShader& pixel_shader,
-    const std::string& out_vert_fname, const std::string& out_frag_fname
-)
+bool ShaderUtil::isDecompilerAvailable_()
 {
     if (sTempPath.empty() ||
         !FolderExists(sTempPath.c_str()))
@@ -985,6 +1520,18 @@ bool ShaderUtil::decompileGsh(
         return false;
     }
 
+    return true;
+}
+
+bool ShaderUtil::decompileGsh(
+    const GX2VertexShader& vertex_shader,
+    const GX2PixelShader& pixel_shader,
+    const std::string& out_vert_fname, const std::string& out_frag_fname
+)
+{
+    if (!isDecompilerAvailable_())
+        return false;
+
     if (out_vert_fname.empty() ||
         out_frag_fname.empty())
     {
@@ -1005,7 +1552,7 @@ bool ShaderUtil::decompileGsh(
         out_vert_native_fname = device->getNativePath(out_vert_fname_no_drive);
         RIO_SHADER_DEBUG_LOG("Vertex shader: %s\n", out_vert_native_fname.c_str());
         if (FileExists(out_vert_native_fname.c_str()))
-            DeleteFile(out_vert_native_fname.c_str());
+            RemoveFile(out_vert_native_fname.c_str());
     }
     // Fragment
     {
@@ -1018,7 +1565,7 @@ bool ShaderUtil::decompileGsh(
         out_frag_native_fname = device->getNativePath(out_frag_fname_no_drive);
         RIO_SHADER_DEBUG_LOG("Fragment shader: %s\n", out_frag_native_fname.c_str());
         if (FileExists(out_frag_native_fname.c_str()))
-            DeleteFile(out_frag_native_fname.c_str());
+            RemoveFile(out_frag_native_fname.c_str());
     }
 
     std::string vert_src;
@@ -1038,3 +1585,24 @@ bool ShaderUtil::decompileGsh(
     return FileExists(out_vert_native_fname.c_str()) &&
            FileExists(out_frag_native_fname.c_str());
 }
+
+bool ShaderUtil::cacheGsh(
+    const GX2VertexShader& vertex_shader,
+    const GX2PixelShader& pixel_shader
+)
+{
+    if (!isDecompilerAvailable_())
+        return false;
+
+    std::string vert_src;
+    std::string frag_src;
+    return DecompileProgram(
+        &vertex_shader, &pixel_shader,
+        &vert_src, &frag_src
+    );
+}
+
+void ShaderUtil::flushCache()
+{
+    sDecompileCache.flush();
+}
@@ -0,0 +1,346 @@
+#include <resource/SZSCompressor.h>
+
+#include <misc/rio_MemUtil.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+constexpr s32 cWindowSize   = 0x1000;
+constexpr s32 cMinMatch     = 3;
+constexpr s32 cMaxShortLen  = 0x11;
+constexpr s32 cMaxMatch     = 0x111;
+constexpr s32 cHashBits     = 15;
+
+struct LevelParam
+{
+    s32     max_chain;      // Number of hash chain candidates tried per position
+    s32     nice_length;    // Stop searching once a match this long is found
+    bool    lazy;           // Defer a match by one byte if the next position has a longer one
+    bool    optimal;        // Choose the parse minimizing the output size
+};
+
+const LevelParam cLevelParam[] = {
+    { 8,            0x20,       false,  false   }, // LEVEL_FAST
+    { 64,           0x80,       true,   false   }, // LEVEL_DEFAULT
+    { 1024,         cMaxMatch,  false,  true    }, // LEVEL_OPTIMAL
+};
+
+struct Match
+{
+    s32 len;
+    s32 offset;
+};
+
+class MatchFinder
+{
+public:
+    MatchFinder(const u8* src, s32 src_size, const LevelParam& param)
+        : mSrc(src)
+        , mSrcSize(src_size)
+        , mParam(param)
+        , mHead(1 << cHashBits, -1)
+        , mPrev(cWindowSize, -1)
+    {
+    }
+
+    void insert(s32 pos)
+    {
+        if (pos + cMinMatch > mSrcSize)
+            return;
+
+        u32 hash = calcHash_(pos);
+        mPrev[pos & (cWindowSize - 1)] = mHead[hash];
+        mHead[hash] = pos;
+    }
+
+    // Must be called before pos is inserted
+    Match find(s32 pos) const
+    {
+        Match match = { 0, 0 };
+
+        if (pos + cMinMatch > mSrcSize)
+            return match;
+
+        const s32 max_len = std::min(cMaxMatch, mSrcSize - pos);
+        const s32 nice_len = std::min(mParam.nice_length, max_len);
+        const u8* const cur = mSrc + pos;
+
+        s32 cand = mHead[calcHash_(pos)];
+        for (s32 chain = mParam.max_chain; cand >= 0 && pos - cand <= cWindowSize && chain > 0; chain--)
+        {
+            const u8* const ref = mSrc + cand;
+            if (ref[match.len] == cur[match.len])
+            {
+                s32 len = 0;
+                while (len < max_len && ref[len] == cur[len])
+                    len++;
+
+                if (len > match.len)
+                {
+                    match.len = len;
+                    match.offset = pos - cand;
+                    if (len >= nice_len)
+                        break;
+                }
+            }
+
+            s32 next = mPrev[cand & (cWindowSize - 1)];
+            if (next >= cand)
+                break;
+
+            cand = next;
+        }
+
+        if (match.len < cMinMatch)
+            match.len = 0;
+
+        return match;
+    }
+
+private:
+    u32 calcHash_(s32 pos) const
+    {
+        u32 v = u32(mSrc[pos]) << 16 | u32(mSrc[pos + 1]) << 8 | mSrc[pos + 2];
+        return (v * 2654435761u) >> (32 - cHashBits);
+    }
+
+private:
+    const u8*           mSrc;
+    s32                 mSrcSize;
+    const LevelParam&   mParam;
+    std::vector<s32>    mHead;
+    std::vector<s32>    mPrev;
+};
+
+class TokenWriter
+{
+public:
+    TokenWriter(u8* dst)
+        : mDst(dst)
+        , mFlagPtr(nullptr)
+        , mFlagMask(0)
+    {
+    }
+
+    void writeLiteral(u8 value)
+    {
+        beginToken_();
+        *mFlagPtr |= mFlagMask;
+        *mDst++ = value;
+    }
+
+    void writeMatch(const Match& match)
+    {
+        beginToken_();
+
+        u32 offset = match.offset - 1;
+        if (match.len > cMaxShortLen)
+        {
+            *mDst++ = offset >> 8;
+            *mDst++ = offset;
+            *mDst++ = match.len - (cMaxShortLen + 1);
+        }
+        else
+        {
+            *mDst++ = (match.len - 2) << 4 | offset >> 8;
+            *mDst++ = offset;
+        }
+    }
+
+    u8* getCurrentPtr() const
+    {
+        return mDst;
+    }
+
+private:
+    void beginToken_()
+    {
+        mFlagMask >>= 1;
+        if (mFlagMask == 0)
+        {
+            mFlagPtr = mDst++;
+            *mFlagPtr = 0;
+            mFlagMask = 0x80;
+        }
+    }
+
+private:
+    u8* mDst;
+    u8* mFlagPtr;
+    u32 mFlagMask;
+};
+
+void encodeGreedy_(TokenWriter& writer, const u8* src, s32 src_size, const LevelParam& param)
+{
+    MatchFinder finder(src, src_size, param);
+
+    s32 pos = 0;
+    Match match = finder.find(pos);
+
+    while (pos < src_size)
+    {
+        finder.insert(pos);
+
+        if (match.len != 0)
+        {
+            if (param.lazy && match.len < param.nice_length)
+            {
+                Match next = finder.find(pos + 1);
+                if (next.len > match.len)
+                {
+                    writer.writeLiteral(src[pos]);
+                    pos++;
+                    match = next;
+                    continue;
+                }
+            }
+
+            writer.writeMatch(match);
+
+            for (s32 i = 1; i < match.len; i++)
+                finder.insert(pos + i);
+
+            pos += match.len;
+        }
+        else
+        {
+            writer.writeLiteral(src[pos]);
+            pos++;
+        }
+
+        match = finder.find(pos);
+    }
+}
+
+void encodeOptimal_(TokenWriter& writer, const u8* src, s32 src_size, const LevelParam& param)
+{
+    // Longest match at every position; any shorter length at the same offset is valid too
+    std::vector<Match> matches(src_size);
+    {
+        MatchFinder finder(src, src_size, param);
+        for (s32 pos = 0; pos < src_size; pos++)
+        {
+            matches[pos] = finder.find(pos);
+            finder.insert(pos);
+        }
+    }
+
+    // Cost in bits of encoding src[pos...] (every token also takes one flag bit)
+    constexpr u32 cLiteralCost      = 1 + 8;
+    constexpr u32 cShortMatchCost   = 1 + 16;
+    constexpr u32 cLongMatchCost    = 1 + 24;
+
+    std::vector<u32> cost(src_size + 1);
+    std::vector<s16> length(src_size);
+
+    cost[src_size] = 0;
+    for (s32 pos = src_size - 1; pos >= 0; pos--)
+    {
+        u32 best_cost = cost[pos + 1] + cLiteralCost;
+        s32 best_len = 1;
+
+        for (s32 len = cMinMatch; len <= matches[pos].len; len++)
+        {
+            u32 c = cost[pos + len] + (len > cMaxShortLen ? cLongMatchCost : cShortMatchCost);
+            if (c < best_cost)
+            {
+                best_cost = c;
+                best_len = len;
+            }
+        }
+
+        cost[pos] = best_cost;
+        length[pos] = best_len;
+    }
+
+    for (s32 pos = 0; pos < src_size; )
+    {
+        if (length[pos] == 1)
+        {
+            writer.writeLiteral(src[pos]);
+            pos++;
+        }
+        else
+        {
+            Match match = { length[pos], matches[pos].offset };
+            writer.writeMatch(match);
+            pos += match.len;
+        }
+    }
+}
+
+void writeU32BE_(u8* dst, u32 value)
+{
+    dst[0] = value >> 24;
+    dst[1] = value >> 16;
+    dst[2] = value >> 8;
+    dst[3] = value;
+}
+
+}
+
+u32 SZSCompressor::encode(
+    void* dst, u32 dst_size, const void* src, u32 src_size,
+    Level level, u32 decomp_alignment
+)
+{
+    RIO_ASSERT(dst);
+    RIO_ASSERT(src || src_size == 0);
+    RIO_ASSERT(u32(level) <= LEVEL_OPTIMAL);
+
+    if (dst_size < getRequiredMemorySize(src_size))
+    {
+        RIO_LOG("SZSCompressor::encode(): dst_size[%u] is smaller than required size[%u].\n", dst_size, getRequiredMemorySize(src_size));
+        return 0;
+    }
+
+    u8* const dst8 = static_cast<u8*>(dst);
+
+    dst8[0] = 'Y';
+    dst8[1] = 'a';
+    dst8[2] = 'z';
+    dst8[3] = '0';
+    writeU32BE_(dst8 + 4, src_size);
+    writeU32BE_(dst8 + 8, decomp_alignment);
+    writeU32BE_(dst8 + 12, 0);
+
+    TokenWriter writer(dst8 + getHeaderSize());
+
+    const LevelParam& param = cLevelParam[level];
+    if (param.optimal)
+        encodeOptimal_(writer, static_cast<const u8*>(src), src_size, param);
+    else
+        encodeGreedy_(writer, static_cast<const u8*>(src), src_size, param);
+
+    return writer.getCurrentPtr() - dst8;
+}
+
+u8* SZSCompressor::tryCompress(
+    const void* src, u32 src_size, u32* out_size,
+    Level level, u32 decomp_alignment, s32 alignment
+)
+{
+    const u32 buffer_size = getRequiredMemorySize(src_size);
+
+    u8* dst = static_cast<u8*>(rio::MemUtil::alloc(buffer_size, alignment));
+    if (!dst)
+    {
+        RIO_LOG("SZSCompressor::tryCompress(): cannot alloc dst buf\n");
+        RIO_ASSERT(false);
+        return nullptr;
+    }
+
+    u32 size = encode(dst, buffer_size, src, src_size, level, decomp_alignment);
+    if (size == 0)
+    {
+        rio::MemUtil::free(dst);
+        return nullptr;
+    }
+
+    if (out_size)
+        *out_size = size;
+
+    return dst;
+}
@@ -3,6 +3,23 @@
 #include <math/rio_Math.h>
 #include <misc/rio_MemUtil.h>
 
+#include <algorithm>
+
+#if !RIO_IS_CAFE
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#endif // RIO_IS_CAFE
+
+#if !RIO_IS_CAFE
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+#endif // RIO_IS_CAFE
+
 SZSDecompressor::DecompContext::DecompContext()
 {
     initialize(NULL);
@@ -26,24 +43,32 @@ void SZSDecompressor::DecompContext::initialize(void* dst)
     headerSize      = SZSDecompressor::getHeaderSize();
 }
 
-u8* SZSDecompressor::tryDecomp(rio::FileDevice::LoadArg& arg, bool reject_uncompressed)
+const u8* SZSDecompressor::loadSrc_(const rio::FileDevice::LoadArg& arg, bool reject_uncompressed, u32* src_size)
 {
-    const u8*   src         = nullptr;
-    u32         src_size    = 0;
-    {
-        rio::FileDevice::LoadArg load_arg;
-        load_arg.path = arg.path;
-        if (!reject_uncompressed)
-            load_arg.alignment = arg.alignment;
+    rio::FileDevice::LoadArg load_arg;
+    load_arg.path = arg.path;
+    if (!reject_uncompressed)
+        load_arg.alignment = arg.alignment;
 
-        src = rio::FileDeviceMgr::instance()->tryLoad(load_arg);
-        if (src)
-        {
-            RIO_ASSERT(load_arg.need_unload);
-            src_size = load_arg.read_size;
-        }
+    const u8* src = rio::FileDeviceMgr::instance()->tryLoad(load_arg);
+    if (src)
+    {
+        RIO_ASSERT(load_arg.need_unload);
+        *src_size = load_arg.read_size;
+    }
+    else
+    {
+        *src_size = 0;
     }
 
+    return src;
+}
+
+u8* SZSDecompressor::tryDecomp(rio::FileDevice::LoadArg& arg, bool reject_uncompressed)
+{
+    u32 src_size = 0;
+    const u8* src = loadSrc_(arg, reject_uncompressed, &src_size);
+
     return tryDecomp_(
         src, src_size, true, reject_uncompressed,
         arg.buffer, arg.buffer_size, arg.alignment,
@@ -51,6 +76,190 @@ u8* SZSDecompressor::tryDecomp(rio::FileDevice::LoadArg& arg, bool reject_uncomp
     );
 }
 
+std::vector<u8*> SZSDecompressor::tryDecompBatch(std::span<rio::FileDevice::LoadArg> args, bool reject_uncompressed, s32 thread_num)
+{
+    std::vector<u8*> dst(args.size(), nullptr);
+
+#if RIO_IS_CAFE
+    (void)thread_num;
+
+    for (size_t i = 0; i < args.size(); i++)
+        dst[i] = tryDecomp(args[i], reject_uncompressed);
+#else
+    if (args.empty())
+        return dst;
+
+    if (thread_num <= 0)
+        thread_num = std::max<s32>(std::thread::hardware_concurrency(), 1);
+
+    thread_num = std::min<s32>(thread_num, args.size());
+
+    struct Source
+    {
+        size_t      index;
+        const u8*   data;
+        u32         size;
+    };
+
+    // Read files are handed to the workers through a bounded queue,
+    // so that reading cannot run arbitrarily far ahead of decoding
+    const size_t queue_max = thread_num * 2;
+
+    std::deque<Source>      queue;
+    bool                    read_done = false;
+    std::mutex              mutex;
+    std::condition_variable cond_not_empty;
+    std::condition_variable cond_not_full;
+
+    auto worker = [&]()
+    {
+        for (;;)
+        {
+            Source src;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cond_not_empty.wait(lock, [&]() { return !queue.empty() || read_done; });
+                if (queue.empty())
+                    break;
+
+                src = queue.front();
+                queue.pop_front();
+            }
+            cond_not_full.notify_one();
+
+            rio::FileDevice::LoadArg& arg = args[src.index];
+
+            dst[src.index] = tryDecomp_(
+                src.data, src.size, true, reject_uncompressed,
+                arg.buffer, arg.buffer_size, arg.alignment,
+                &arg.read_size, &arg.roundup_size, &arg.need_unload
+            );
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(thread_num);
+    for (s32 i = 0; i < thread_num; i++)
+        threads.emplace_back(worker);
+
+    for (size_t i = 0; i < args.size(); i++)
+    {
+        u32 src_size = 0;
+        const u8* src = loadSrc_(args[i], reject_uncompressed, &src_size);
+        if (!src)
+            continue;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cond_not_full.wait(lock, [&]() { return queue.size() < queue_max; });
+            queue.push_back({ i, src, src_size });
+        }
+        cond_not_empty.notify_one();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        read_done = true;
+    }
+    cond_not_empty.notify_all();
+
+    for (std::thread& thread : threads)
+        thread.join();
+#endif // RIO_IS_CAFE
+
+    return dst;
+}
+
+u8* SZSDecompressor::tryDecompStreaming(
+        rio::FileDevice::LoadArg& arg, u32 chunk_size,
+        ProgressCallback callback, void* user_data
+)
+{
+    RIO_ASSERT(chunk_size >= getHeaderSize());
+
+    rio::FileHandle handle;
+    rio::FileDevice* device = rio::FileDeviceMgr::instance()->tryOpen(&handle, arg.path, rio::FileDevice::FILE_OPEN_FLAG_READ);
+    if (!device)
+        return nullptr;
+
+    u8* chunk = static_cast<u8*>(rio::MemUtil::alloc(chunk_size, rio::FileDevice::cBufferMinAlignment));
+    if (!chunk)
+    {
+        RIO_LOG("SZSDecompressor::tryDecompStreaming(): cannot alloc chunk buf\n");
+        RIO_ASSERT(false);
+
+        device->close(&handle);
+        return nullptr;
+    }
+
+    u8* dst = nullptr;
+    u32 decomp_size = 0;
+    u32 buffer_size = 0;
+    bool need_delete = false;
+
+    do
+    {
+        u32 read_size = 0;
+        if (!device->tryRead(&read_size, &handle, chunk, chunk_size))
+            break;
+
+        if (read_size < getHeaderSize() || getMagic(chunk) != 0x59617A30) // Yaz0
+        {
+            RIO_LOG("SZSDecompressor::tryDecompStreaming(): File is not SZS.\n");
+            RIO_ASSERT(false);
+            break;
+        }
+
+        dst = prepareDst_(chunk, arg.buffer, arg.buffer_size, arg.alignment, &decomp_size, &buffer_size, &need_delete);
+        if (!dst)
+            break;
+
+        DecompContext context(dst);
+        context.forceDestCount = decomp_size;
+
+        for (;;)
+        {
+            s32 error = streamDecomp(&context, chunk, read_size);
+            if (error < 0)
+            {
+                RIO_LOG("SZSDecompressor::tryDecompStreaming(): streamDecomp() returned error(%d).\n", error);
+                RIO_ASSERT(false);
+
+                if (need_delete)
+                    rio::MemUtil::free(dst);
+
+                dst = nullptr;
+                break;
+            }
+
+            if (callback)
+                callback(decomp_size - error, decomp_size, user_data);
+
+            if (error == 0)
+                break;
+
+            if (!device->tryRead(&read_size, &handle, chunk, chunk_size) || read_size == 0)
+            {
+                RIO_LOG("SZSDecompressor::tryDecompStreaming(): Warning: incomplete src data, dst missing %d bytes.\n", error);
+                break;
+            }
+        }
+    }
+    while (false);
+
+    rio::MemUtil::free(chunk);
+    device->close(&handle);
+
+    if (dst)
+    {
+        arg.read_size = decomp_size;
+        arg.roundup_size = buffer_size;
+        arg.need_unload = need_delete;
+    }
+
+    return dst;
+}
+
 u8* SZSDecompressor::tryDecomp_(
         const u8* src, u32 src_size, bool src_need_delete, bool reject_uncompressed,
         u8* dst, u32 dst_size, s32 alignment,
@@ -105,13 +314,72 @@ u8* SZSDecompressor::tryDecomp_(
         return nullptr;
     }
 
-    u32 decomp_size = getDecompSize(src);
+    u32 decomp_size;
+    u32 buffer_size;
+    bool need_delete;
+
+    dst = prepareDst_(src, dst, dst_size, alignment, &decomp_size, &buffer_size, &need_delete);
+    if (!dst)
+    {
+        if (src_need_delete)
+            rio::MemUtil::free(const_cast<u8*>(src));
+
+        return nullptr;
+    }
+
+#if RIO_IS_CAFE
+    s32 error = decomp(dst, buffer_size, src, src_size);
+#else
+    s32 error = decompFast(dst, decomp_size, src, src_size);
+    if (error > 0)
+    {
+        // When the return is > 0, it's the expected remaining length of decompressed data (dst)
+        RIO_LOG("SZSDecompressor::tryDecomp_(): Warning: incomplete src data, dst missing %d bytes.\n", error);
+    }
+    else
+#endif // RIO_IS_CAFE
+    if (error < 0)
+    {
+        RIO_LOG("SZSDecompressor::tryDecomp_(): decomp() returned error(%d).\n", error);
+        RIO_ASSERT(false);
+
+        if (need_delete)
+            delete[] dst;
+
+        if (src_need_delete)
+            rio::MemUtil::free(const_cast<u8*>(src));
+
+        return nullptr;
+    }
+
+
+    if (src_need_delete)
+        rio::MemUtil::free(const_cast<u8*>(src));
+
+    if (out_size)
+        *out_size = decomp_size;
+
+    if (out_buffer_size)
+        *out_buffer_size = buffer_size;
+
+    if (out_need_delete)
+        *out_need_delete = need_delete;
+
+    return dst;
+}
+
+u8* SZSDecompressor::prepareDst_(
+        const void* header, u8* dst, u32 dst_size, s32 alignment,
+        u32* out_decomp_size, u32* out_buffer_size, bool* out_need_delete
+)
+{
+    u32 decomp_size = getDecompSize(header);
     RIO_ASSERT(decomp_size > 0);
 
-    s32 decomp_alignment = getDecompAlignment(src);
+    s32 decomp_alignment = getDecompAlignment(header);
     if (decomp_alignment && (decomp_alignment & -decomp_alignment) != rio::Mathi::abs(decomp_alignment))
     {
-        RIO_LOG("SZSDecompressor::tryDecomp_(): decomp_alignment[%d] must be power of 2.\n", decomp_alignment);
+        RIO_LOG("SZSDecompressor::prepareDst_(): decomp_alignment[%d] must be power of 2.\n", decomp_alignment);
         RIO_ASSERT(false);
     }
 
@@ -139,7 +407,7 @@ u8* SZSDecompressor::tryDecomp_(
         {
             if (decomp_alignment && (alignment % decomp_alignment))
             {
-                RIO_LOG("SZSDecompressor::tryDecomp_(): alignment[%d] doesn\'t meet decomp_alignment[%d].\n", alignment, decomp_alignment);
+                RIO_LOG("SZSDecompressor::prepareDst_(): alignment[%d] doesn\'t meet decomp_alignment[%d].\n", alignment, decomp_alignment);
                 RIO_ASSERT(false);
             }
         }
@@ -147,12 +415,9 @@ u8* SZSDecompressor::tryDecomp_(
         dst = static_cast<u8*>(rio::MemUtil::alloc(buffer_size, alignment));
         if (!dst)
         {
-            RIO_LOG("SZSDecompressor::tryDecomp_(): cannot alloc dst buf\n");
+            RIO_LOG("SZSDecompressor::prepareDst_(): cannot alloc dst buf\n");
             RIO_ASSERT(false);
 
-            if (src_need_delete)
-                rio::MemUtil::free(const_cast<u8*>(src));
-
             return nullptr;
         }
         else
@@ -165,52 +430,15 @@ u8* SZSDecompressor::tryDecomp_(
         if (decomp_alignment && ((uintptr_t)dst & (decomp_alignment - 1u)))
         {
 #if !RIO_IS_WIN
-            RIO_LOG("SZSDecompressor::tryDecomp_(): dst is not aligned with decomp_alignment[%d]\n", decomp_alignment);
+            RIO_LOG("SZSDecompressor::prepareDst_(): dst is not aligned with decomp_alignment[%d]\n", decomp_alignment);
             RIO_ASSERT(false);
 #endif
         }
     }
 
-#if RIO_IS_CAFE
-    s32 error = decomp(dst, buffer_size, src, src_size);
-#else
-    DecompContext context(dst);
-    context.forceDestCount = decomp_size;
-
-    s32 error = streamDecomp(&context, src, src_size);
-    if (error > 0)
-    {
-        // When the return is > 0, it's the expected remaining length of decompressed data (dst)
-        RIO_LOG("SZSDecompressor::tryDecomp_(): Warning: incomplete src data, dst missing %d bytes.\n", error);
-    }
-    else
-#endif // RIO_IS_CAFE
-    if (error < 0)
-    {
-        RIO_LOG("SZSDecompressor::tryDecomp_(): decomp() returned error(%d).\n", error);
-        RIO_ASSERT(false);
-
-        if (need_delete)
-            delete[] dst;
-
-        if (src_need_delete)
-            rio::MemUtil::free(const_cast<u8*>(src));
-
-        return nullptr;
-    }
-
-
-    if (src_need_delete)
-        rio::MemUtil::free(const_cast<u8*>(src));
-
-    if (out_size)
-        *out_size = decomp_size;
-
-    if (out_buffer_size)
-        *out_buffer_size = buffer_size;
-
-    if (out_need_delete)
-        *out_need_delete = need_delete;
+    *out_decomp_size = decomp_size;
+    *out_buffer_size = buffer_size;
+    *out_need_delete = need_delete;
 
     return dst;
 }
@@ -397,6 +625,157 @@ s32 SZSDecompressor::decomp(void* dst, u32 dst_size, const void* src, u32 src_si
     return decodeSZSCafeAsm_(dst, src);
 }
 
+#else
+
+namespace {
+
+inline void copy8_(u8* dst, const u8* src)
+{
+    u64 v;
+    std::memcpy(&v, src, sizeof(u64));
+    std::memcpy(dst, &v, sizeof(u64));
+}
+
+inline void copy16_(u8* dst, const u8* src)
+{
+#if defined(__SSE2__) || defined(_M_X64)
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+#else
+    copy8_(dst, src);
+    copy8_(dst + 8, src + 8);
+#endif
+}
+
+// Copies n bytes from destp - offset to destp.
+// Wide copies may write up to 15 bytes past destp + n, but never past destp + dest_left.
+// Those bytes are overwritten by the following tokens before anything reads them back.
+inline void copyMatch_(u8* destp, u32 offset, u32 n, u32 dest_left)
+{
+    const u8* srcp = destp - offset;
+
+    if (offset >= 16 && n + 15 <= dest_left)
+    {
+        for (s32 i = n; i > 0; i -= 16)
+        {
+            copy16_(destp, srcp);
+            destp += 16;
+            srcp += 16;
+        }
+    }
+    else if (offset >= 8 && n + 7 <= dest_left)
+    {
+        for (s32 i = n; i > 0; i -= 8)
+        {
+            copy8_(destp, srcp);
+            destp += 8;
+            srcp += 8;
+        }
+    }
+    else if (offset == 1)
+    {
+        std::memset(destp, *srcp, n);
+    }
+    else
+    {
+        do
+        {
+            *destp++ = *srcp++;
+        }
+        while (--n != 0);
+    }
+}
+
+}
+
+s32 SZSDecompressor::decompFast(void* dst, u32 dst_size, const void* src, u32 src_size)
+{
+    RIO_ASSERT(dst);
+    RIO_ASSERT(src);
+
+    if (src_size < getHeaderSize())
+        return -1;
+
+    if (getMagic(src) != 0x59617A30) // Yaz0
+        return -1;
+
+    u32 decomp_size = getDecompSize(src);
+    if (decomp_size > dst_size)
+        decomp_size = dst_size;
+
+    const u8*       srcp        = static_cast<const u8*>(src) + getHeaderSize();
+    const u8* const src_end     = static_cast<const u8*>(src) + src_size;
+    u8* const       dest_begin  = static_cast<u8*>(dst);
+    u8*             destp       = dest_begin;
+    u8* const       dest_end    = dest_begin + decomp_size;
+
+    u32 flags = 0;
+    u32 flag_mask = 0;
+
+    while (destp < dest_end && srcp < src_end)
+    {
+        if (flag_mask == 0)
+        {
+            flags = *srcp++;
+            flag_mask = 0x80;
+            if (srcp == src_end)
+                break;
+
+            // Eight literals in a row
+            if (flags == 0xFF && src_end - srcp >= 8 && dest_end - destp >= 8)
+            {
+                copy8_(destp, srcp);
+                destp += 8;
+                srcp += 8;
+                flag_mask = 0;
+                continue;
+            }
+        }
+
+        if ((flags & flag_mask) != 0)
+        {
+            *destp++ = *srcp++;
+        }
+        else
+        {
+            // Matches cut off by the end of src are left for the caller, as with streamDecomp()
+            if (src_end - srcp < 2)
+                break;
+
+            u32 offsetLen = static_cast<u32>(srcp[0]) << 8 | srcp[1];
+            u32 offset = (offsetLen & 0xFFFu) + 1;
+
+            u32 n = offsetLen >> 12;
+            if (n == 0)
+            {
+                if (src_end - srcp < 3)
+                    break;
+
+                n = srcp[2] + 0x12;
+                srcp += 3;
+            }
+            else
+            {
+                n += 2;
+                srcp += 2;
+            }
+
+            if (offset > static_cast<u32>(destp - dest_begin))
+                return -1;
+
+            u32 dest_left = dest_end - destp;
+            if (n > dest_left)
+                n = dest_left;
+
+            copyMatch_(destp, offset, n, dest_left);
+            destp += n;
+        }
+
+        flag_mask >>= 1;
+    }
+
+    return dest_end - destp;
+}
+
 #endif // RIO_IS_CAFE
 
 s32 SZSDecompressor::readHeader_(DecompContext* context, const u8* srcp, u32 src_size)
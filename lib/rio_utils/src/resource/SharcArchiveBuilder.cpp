@@ -0,0 +1,261 @@
+#include <resource/SharcArchiveBuilder.h>
+#include <resource/SharcHasher.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+inline u32 AlignUp(u32 value, u32 alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+inline void WriteU16(u8* dst, u16 value, bool is_be)
+{
+    if (is_be)
+    {
+        dst[0] = value >> 8;
+        dst[1] = value;
+    }
+    else
+    {
+        dst[0] = value;
+        dst[1] = value >> 8;
+    }
+}
+
+inline void WriteU32(u8* dst, u32 value, bool is_be)
+{
+    if (is_be)
+    {
+        dst[0] = value >> 24;
+        dst[1] = value >> 16;
+        dst[2] = value >> 8;
+        dst[3] = value;
+    }
+    else
+    {
+        dst[0] = value;
+        dst[1] = value >> 8;
+        dst[2] = value >> 16;
+        dst[3] = value >> 24;
+    }
+}
+
+}
+
+void SharcArchiveBuilder::addFile(const char* file_path, const void* data, u32 size, u32 alignment)
+{
+    RIO_ASSERT(file_path);
+    RIO_ASSERT(data || size == 0);
+
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+    {
+        RIO_LOG("SharcArchiveBuilder::addFile(): alignment[%u] must be power of 2.\n", alignment);
+        RIO_ASSERT(false);
+        alignment = cDefaultAlignment;
+    }
+
+    mEntry.push_back({ file_path, data, size, alignment });
+}
+
+bool SharcArchiveBuilder::calcLayout_(Layout* layout) const
+{
+    const s32 num = mEntry.size();
+    if (num > SharcArchiveRes::cArchiveEntryMax)
+    {
+        RIO_LOG("SharcArchiveBuilder::calcLayout_(): Too many files (%d)\n", num);
+        return false;
+    }
+
+    std::vector<u32> hash(num);
+    for (s32 i = 0; i < num; i++)
+        hash[i] = sharcCalcHash32(mEntry[i].path.c_str(), mHashKey);
+
+    layout->order.resize(num);
+    for (s32 i = 0; i < num; i++)
+        layout->order[i] = i;
+
+    std::stable_sort(
+        layout->order.begin(), layout->order.end(),
+        [&hash](s32 lhs, s32 rhs) { return hash[lhs] < hash[rhs]; }
+    );
+
+    layout->hash.resize(num);
+    layout->name_offset.resize(num);
+    layout->data_offset.resize(num);
+
+    // File name table
+    u32 fnt_size = 0;
+    u32 collision_index = 0;
+    u32 max_alignment = SharcArchiveRes::cFileNameTableAlign;
+
+    for (s32 i = 0; i < num; i++)
+    {
+        const Entry& entry = mEntry[layout->order[i]];
+        const u32 entry_hash = hash[layout->order[i]];
+
+        if (i > 0 && layout->hash[i - 1] == entry_hash)
+        {
+            // Entries sharing a hash are told apart by name, so names must differ
+            for (s32 j = i - collision_index; j < i; j++)
+            {
+                if (mEntry[layout->order[j]].path == entry.path)
+                {
+                    RIO_LOG("SharcArchiveBuilder::calcLayout_(): Duplicate file: %s\n", entry.path.c_str());
+                    return false;
+                }
+            }
+
+            collision_index++;
+        }
+        else
+        {
+            collision_index = 1;
+        }
+
+        if (collision_index > 0xff || fnt_size / SharcArchiveRes::cFileNameTableAlign > 0x00ffffff)
+        {
+            RIO_LOG("SharcArchiveBuilder::calcLayout_(): File name table overflow\n");
+            return false;
+        }
+
+        layout->hash[i] = entry_hash;
+        layout->name_offset[i] = collision_index << 24 | fnt_size / SharcArchiveRes::cFileNameTableAlign;
+
+        fnt_size = AlignUp(fnt_size + entry.path.size() + 1, SharcArchiveRes::cFileNameTableAlign);
+        max_alignment = std::max(max_alignment, entry.alignment);
+    }
+
+    layout->fnt_size = fnt_size;
+
+    // Data block, aligned to the largest file alignment so that offsets relative to it keep every file aligned
+    const u32 fnt_offset = sizeof(SharcArchiveRes::ArchiveBlockHeader)
+                         + sizeof(SharcArchiveRes::FATBlockHeader)
+                         + num * sizeof(SharcArchiveRes::FATEntry)
+                         + sizeof(SharcArchiveRes::FNTBlockHeader);
+
+    layout->data_block_offset = AlignUp(fnt_offset + fnt_size, max_alignment);
+
+    u32 data_size = 0;
+    for (s32 i = 0; i < num; i++)
+    {
+        const Entry& entry = mEntry[layout->order[i]];
+
+        data_size = AlignUp(data_size, entry.alignment);
+        layout->data_offset[i] = data_size;
+        data_size += entry.size;
+    }
+
+    layout->file_size = layout->data_block_offset + data_size;
+    return true;
+}
+
+u32 SharcArchiveBuilder::calcArchiveSize() const
+{
+    Layout layout;
+    if (!calcLayout_(&layout))
+        return 0;
+
+    return layout.file_size;
+}
+
+u32 SharcArchiveBuilder::build(void* dst, u32 dst_size) const
+{
+    RIO_ASSERT(dst);
+
+    Layout layout;
+    if (!calcLayout_(&layout))
+        return 0;
+
+    if (dst_size < layout.file_size)
+    {
+        RIO_LOG("SharcArchiveBuilder::build(): dst_size[%u] is smaller than archive size[%u].\n", dst_size, layout.file_size);
+        return 0;
+    }
+
+    write_(layout, static_cast<u8*>(dst));
+    return layout.file_size;
+}
+
+u32 SharcArchiveBuilder::build(std::vector<u8>& dst) const
+{
+    Layout layout;
+    if (!calcLayout_(&layout))
+        return 0;
+
+    dst.resize(layout.file_size);
+
+    write_(layout, dst.data());
+    return layout.file_size;
+}
+
+void SharcArchiveBuilder::write_(const Layout& layout, u8* dst) const
+{
+    const s32 num = mEntry.size();
+    const bool is_be = mIsBigEndian;
+
+    u8* p = dst;
+
+    // Archive block header
+    std::memcpy(p, "SARC", 4);
+    WriteU16(p + 0x4, sizeof(SharcArchiveRes::ArchiveBlockHeader), is_be);
+    WriteU16(p + 0x6, 0xfeff, is_be);
+    WriteU32(p + 0x8, layout.file_size, is_be);
+    WriteU32(p + 0xC, layout.data_block_offset, is_be);
+    WriteU16(p + 0x10, SharcArchiveRes::cArchiveVersion, is_be);
+    WriteU16(p + 0x12, 0, is_be);
+    p += sizeof(SharcArchiveRes::ArchiveBlockHeader);
+
+    // FAT
+    std::memcpy(p, "SFAT", 4);
+    WriteU16(p + 0x4, sizeof(SharcArchiveRes::FATBlockHeader), is_be);
+    WriteU16(p + 0x6, num, is_be);
+    WriteU32(p + 0x8, mHashKey, is_be);
+    p += sizeof(SharcArchiveRes::FATBlockHeader);
+
+    for (s32 i = 0; i < num; i++)
+    {
+        const Entry& entry = mEntry[layout.order[i]];
+
+        WriteU32(p + 0x0, layout.hash[i], is_be);
+        WriteU32(p + 0x4, layout.name_offset[i], is_be);
+        WriteU32(p + 0x8, layout.data_offset[i], is_be);
+        WriteU32(p + 0xC, layout.data_offset[i] + entry.size, is_be);
+        p += sizeof(SharcArchiveRes::FATEntry);
+    }
+
+    // FNT
+    std::memcpy(p, "SFNT", 4);
+    WriteU16(p + 0x4, sizeof(SharcArchiveRes::FNTBlockHeader), is_be);
+    WriteU16(p + 0x6, 0, is_be);
+    p += sizeof(SharcArchiveRes::FNTBlockHeader);
+
+    u8* const fnt = p;
+    std::memset(fnt, 0, layout.fnt_size);
+
+    for (s32 i = 0; i < num; i++)
+    {
+        const std::string& path = mEntry[layout.order[i]].path;
+        const u32 offset = (layout.name_offset[i] & 0x00ffffff) * SharcArchiveRes::cFileNameTableAlign;
+        std::memcpy(fnt + offset, path.c_str(), path.size() + 1);
+    }
+    p = fnt + layout.fnt_size;
+
+    // Data block
+    u8* const data_block = dst + layout.data_block_offset;
+    std::memset(p, 0, data_block - p);
+
+    u32 data_pos = 0;
+    for (s32 i = 0; i < num; i++)
+    {
+        const Entry& entry = mEntry[layout.order[i]];
+
+        std::memset(data_block + data_pos, 0, layout.data_offset[i] - data_pos);
+        if (entry.size > 0)
+            std::memcpy(data_block + layout.data_offset[i], entry.data, entry.size);
+
+        data_pos = layout.data_offset[i] + entry.size;
+    }
+}
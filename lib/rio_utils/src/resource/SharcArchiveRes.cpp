@@ -6,6 +6,13 @@
 
 #include <cstdio>
 
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // __linux__
+
 namespace {
 
 #ifndef __STDC_LIB_EXT1__
@@ -96,8 +103,16 @@ inline uintptr_t GetOffsetFromPtr(const void* a, const void* b)
 
 #define SHARC_ENDIAN_TO_HOST(val) (EndianToHost(mIsBigEndian, (val)))
 
-bool SharcArchiveRes::prepareArchive(const void* archive, bool fatal_errors)
+bool SharcArchiveRes::prepareArchive(const void* archive, bool fatal_errors, bool build_index)
 {
+    return prepareArchive_(archive, cArchiveSizeUnknown, fatal_errors, build_index);
+}
+
+bool SharcArchiveRes::prepareArchive_(const void* archive, size_t archive_size, bool fatal_errors, bool build_index)
+{
+    mIndexSlots.clear();
+    mIndexNames.clear();
+
     if (!archive)
     {
         if (fatal_errors)
@@ -110,6 +125,16 @@ bool SharcArchiveRes::prepareArchive(const void* archive, bool fatal_errors)
 
     const u8* archive8 = reinterpret_cast<const u8*>(archive);
 
+    if (archive_size < sizeof(ArchiveBlockHeader))
+    {
+        if (fatal_errors)
+        {
+            RIO_LOG("SharcArchiveRes::prepareArchive(): Archive is truncated (ArchiveBlockHeader)\n");
+            RIO_ASSERT(false);
+        }
+        return false;
+    }
+
     mArchiveBlockHeader = reinterpret_cast<const ArchiveBlockHeader*>(archive8);
     if (std::strncmp(mArchiveBlockHeader->signature, "SARC", 4) != 0)
     {
@@ -157,6 +182,16 @@ bool SharcArchiveRes::prepareArchive(const void* archive, bool fatal_errors)
         return false;
     }
 
+    if (archive_size < sizeof(ArchiveBlockHeader) + sizeof(FATBlockHeader))
+    {
+        if (fatal_errors)
+        {
+            RIO_LOG("SharcArchiveRes::prepareArchive(): Archive is truncated (FATBlockHeader)\n");
+            RIO_ASSERT(false);
+        }
+        return false;
+    }
+
     mFATBlockHeader = reinterpret_cast<const FATBlockHeader*>(archive8 + SHARC_ENDIAN_TO_HOST(mArchiveBlockHeader->header_size));
     if (std::strncmp(mFATBlockHeader->signature, "SFAT", 4) != 0)
     {
@@ -188,6 +223,18 @@ bool SharcArchiveRes::prepareArchive(const void* archive, bool fatal_errors)
         return false;
     }
 
+    const size_t fnt_offset = sizeof(ArchiveBlockHeader) + sizeof(FATBlockHeader)
+                            + SHARC_ENDIAN_TO_HOST(mFATBlockHeader->file_num) * sizeof(FATEntry);
+    if (archive_size < fnt_offset + sizeof(FNTBlockHeader))
+    {
+        if (fatal_errors)
+        {
+            RIO_LOG("SharcArchiveRes::prepareArchive(): Archive is truncated (FATEntry / FNTBlockHeader)\n");
+            RIO_ASSERT(false);
+        }
+        return false;
+    }
+
     mFATEntrys = {
         reinterpret_cast<const FATEntry*>(
             archive8 + SHARC_ENDIAN_TO_HOST(mArchiveBlockHeader->header_size)
@@ -222,7 +269,7 @@ bool SharcArchiveRes::prepareArchive(const void* archive, bool fatal_errors)
     }
 
     mFNTBlock = reinterpret_cast<const char*>(fnt_header) + SHARC_ENDIAN_TO_HOST(fnt_header->header_size);
-    if (static_cast<s32>(SHARC_ENDIAN_TO_HOST(mArchiveBlockHeader->data_block_offset)) < static_cast<ssize_t>(GetOffsetFromPtr(mArchiveBlockHeader, mFNTBlock)))
+    if (static_cast<s32>(SHARC_ENDIAN_TO_HOST(mArchiveBlockHeader->data_block_offset)) < static_cast<ssize_t>(GetOffsetFromPtr(mFNTBlock, mArchiveBlockHeader)))
     {
         if (fatal_errors)
         {
@@ -232,10 +279,201 @@ bool SharcArchiveRes::prepareArchive(const void* archive, bool fatal_errors)
         return false;
     }
 
-    mDataBlock = archive8 + SHARC_ENDIAN_TO_HOST(mArchiveBlockHeader->data_block_offset);
+    const size_t data_block_offset = SHARC_ENDIAN_TO_HOST(mArchiveBlockHeader->data_block_offset);
+    if (archive_size < data_block_offset)
+    {
+        if (fatal_errors)
+        {
+            RIO_LOG("SharcArchiveRes::prepareArchive(): Archive is truncated (data block)\n");
+            RIO_ASSERT(false);
+        }
+        return false;
+    }
+
+    mDataBlock = archive8 + data_block_offset;
+
+    // Only possible when the size is known, i.e. for mapped archives, where reading past the end
+    // of the file raises SIGBUS instead of returning garbage
+    if (archive_size != cArchiveSizeUnknown)
+    {
+        const size_t fnt_size = data_block_offset - GetOffsetFromPtr(mFNTBlock, mArchiveBlockHeader);
+        const size_t data_size = archive_size - data_block_offset;
+
+        for (size_t id = 0; id < mFATEntrys.size(); id++)
+        {
+            const FATEntry& entry = mFATEntrys[id];
+
+            const u32 start_offset = SHARC_ENDIAN_TO_HOST(entry.data_start_offset);
+            const u32 end_offset = SHARC_ENDIAN_TO_HOST(entry.data_end_offset);
+            if (start_offset > end_offset || end_offset > data_size)
+            {
+                if (fatal_errors)
+                {
+                    RIO_LOG("SharcArchiveRes::prepareArchive(): Archive is truncated (data of entry %zu)\n", id);
+                    RIO_ASSERT(false);
+                }
+                return false;
+            }
+
+            const u32 name_offset = SHARC_ENDIAN_TO_HOST(entry.name_offset);
+            if (name_offset == 0)
+                continue;
+
+            const size_t name_pos = size_t(name_offset & 0x00ffffff) * cFileNameTableAlign;
+            if (name_pos >= fnt_size || std::memchr(mFNTBlock + name_pos, '\0', fnt_size - name_pos) == nullptr)
+            {
+                if (fatal_errors)
+                {
+                    RIO_LOG("SharcArchiveRes::prepareArchive(): Invalid name offset of entry %zu\n", id);
+                    RIO_ASSERT(false);
+                }
+                return false;
+            }
+        }
+    }
+    mHashKey = SHARC_ENDIAN_TO_HOST(mFATBlockHeader->hash_key);
+
+    if (build_index)
+        buildIndex_();
+
+    return true;
+}
+
+void SharcArchiveRes::buildIndex_()
+{
+    const s32 num = mFATEntrys.size();
+    if (num == 0)
+        return;
+
+    std::vector<const char*> names(num);
+    s32 group_num = 0;
+
+    for (s32 id = 0; id < num; id++)
+    {
+        u32 name_offset = SHARC_ENDIAN_TO_HOST(mFATEntrys[id].name_offset);
+        if (name_offset == 0)
+        {
+            names[id] = nullptr;
+        }
+        else
+        {
+            if (reinterpret_cast<const u8*>(mFNTBlock + (name_offset & 0x00ffffff)) > mDataBlock)
+            {
+                RIO_LOG("SharcArchiveRes::buildIndex_(): Warning: Invalid data start offset, not building index\n");
+                return;
+            }
+
+            names[id] = mFNTBlock + (name_offset & 0x00ffffff) * cFileNameTableAlign;
+        }
+
+        if (id == 0 || mFATEntrys[id].hash != mFATEntrys[id - 1].hash)
+            group_num++;
+    }
+
+    // Keep the load factor at or below 50%
+    u32 slot_num = 1;
+    while (slot_num < u32(group_num) * 2)
+        slot_num <<= 1;
+
+    std::vector<IndexSlot> slots(slot_num, IndexSlot{ 0, 0, 0 });
+    const u32 mask = slot_num - 1;
+
+    for (s32 id = 0; id < num; )
+    {
+        u32 hash = SHARC_ENDIAN_TO_HOST(mFATEntrys[id].hash);
+
+        s32 end = id + 1;
+        while (end < num && SHARC_ENDIAN_TO_HOST(mFATEntrys[end].hash) == hash)
+            end++;
+
+        u32 i = hash & mask;
+        while (slots[i].entry_num != 0)
+            i = (i + 1) & mask;
+
+        slots[i].hash = hash;
+        slots[i].entry_id = id;
+        slots[i].entry_num = end - id;
+
+        id = end;
+    }
+
+    mIndexSlots.swap(slots);
+    mIndexNames.swap(names);
+}
+
+#ifdef __linux__
+
+bool SharcArchiveRes::mapArchive(const std::string& native_path, bool writable, bool fatal_errors, bool build_index)
+{
+    destroy();
+
+    s32 fd = open(native_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        if (fatal_errors)
+        {
+            RIO_LOG("SharcArchiveRes::mapArchive(): Could not open %s\n", native_path.c_str());
+            RIO_ASSERT(false);
+        }
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(ArchiveBlockHeader))
+    {
+        close(fd);
+
+        if (fatal_errors)
+        {
+            RIO_LOG("SharcArchiveRes::mapArchive(): Invalid file size\n");
+            RIO_ASSERT(false);
+        }
+        return false;
+    }
+
+    void* archive = mmap(
+        nullptr, st.st_size,
+        writable ? (PROT_READ | PROT_WRITE) : PROT_READ,
+        MAP_PRIVATE, fd, 0
+    );
+
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+
+    if (archive == MAP_FAILED)
+    {
+        if (fatal_errors)
+        {
+            RIO_LOG("SharcArchiveRes::mapArchive(): mmap() failed\n");
+            RIO_ASSERT(false);
+        }
+        return false;
+    }
+
+    mMappedArchive = archive;
+    mMappedSize = st.st_size;
+
+    if (!prepareArchive_(archive, mMappedSize, fatal_errors, build_index))
+    {
+        destroy();
+        return false;
+    }
+
     return true;
 }
 
+void SharcArchiveRes::unmapArchive_()
+{
+    if (mMappedArchive)
+    {
+        munmap(mMappedArchive, mMappedSize);
+        mMappedArchive = nullptr;
+        mMappedSize = 0;
+    }
+}
+
+#endif // __linux__
+
 void* SharcArchiveRes::getFileFastImpl_(s32 entry_id, FileInfo* file_info) const
 {
     if (entry_id < 0 || size_t(entry_id) >= mFATEntrys.size())
@@ -257,9 +495,37 @@ void* SharcArchiveRes::getFileFastImpl_(s32 entry_id, FileInfo* file_info) const
     return const_cast<u8*>(mDataBlock) + start_offset;
 }
 
+s32 SharcArchiveRes::convertPathToEntryIDIndexed_(const char* file_path) const
+{
+    u32 hash = sharcCalcHash32(file_path, mHashKey);
+
+    const u32 mask = mIndexSlots.size() - 1;
+    for (u32 i = hash & mask; ; i = (i + 1) & mask)
+    {
+        const IndexSlot& slot = mIndexSlots[i];
+        if (slot.entry_num == 0)
+            return -1;
+
+        if (slot.hash != hash)
+            continue;
+
+        for (s32 id = slot.entry_id, end = slot.entry_id + slot.entry_num; id < end; id++)
+        {
+            const char* name = mIndexNames[id];
+            if (name == nullptr || std::strcmp(file_path, name) == 0)
+                return id;
+        }
+
+        return -1;
+    }
+}
+
 s32 SharcArchiveRes::convertPathToEntryIDImpl_(const char* file_path) const
 {
-    u32 hash = sharcCalcHash32(file_path, SHARC_ENDIAN_TO_HOST(mFATBlockHeader->hash_key));
+    if (isIndexBuilt())
+        return convertPathToEntryIDIndexed_(file_path);
+
+    u32 hash = sharcCalcHash32(file_path, mHashKey);
 
     s32 start = 0;
     s32 end = mFATEntrys.size();
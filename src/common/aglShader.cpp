@@ -7,6 +7,16 @@
 #include <filedevice/rio_FileDeviceMgr.h>
 #endif // RIO_IS_WIN
 
+namespace {
+
+#if RIO_IS_CAFE || RIO_IS_WIN
+static const agl::ShaderCompileInfo::Target cCompileTarget = agl::ShaderCompileInfo::cTarget_GX2;
+#else
+static const agl::ShaderCompileInfo::Target cCompileTarget = agl::ShaderCompileInfo::cTarget_GL;
+#endif
+
+}
+
 namespace agl {
 
 Shader::Shader()
@@ -15,19 +25,21 @@ Shader::Shader()
 {
 }
 
-u32 Shader::setUp(bool compile_source, bool) const
+u32 Shader::setUp(bool compile_source, bool, const std::string* p_source) const
 {
     u32 ret = 2;
 
     if (mCompileInfo && compile_source)
     {
-        std::string* temp_text = &detail::PrivateResource::sShaderText;
-
-#if RIO_IS_CAFE || RIO_IS_WIN
-        mCompileInfo->calcCompileSource(getShaderType(), temp_text, ShaderCompileInfo::cTarget_GX2, true);
-#else
-        mCompileInfo->calcCompileSource(getShaderType(), temp_text, ShaderCompileInfo::cTarget_GL, true);
-#endif
+        if (p_source)
+        {
+            if (mCompileInfo->getRawText())
+                mCompileInfo->getRawText()->assign(*p_source);
+        }
+        else
+        {
+            mCompileInfo->calcCompileSource(getShaderType(), &detail::PrivateResource::sShaderText, cCompileTarget, true);
+        }
 
 #if RIO_IS_CAFE
         /*
@@ -53,6 +65,19 @@ u32 Shader::setUp(bool compile_source, bool) const
     return ret;
 }
 
+void Shader::calcCompileSource(std::string* p_buffer, const std::unordered_map<std::string, const std::string>& variation_map) const
+{
+    RIO_ASSERT(p_buffer != nullptr);
+
+    if (!mCompileInfo)
+    {
+        p_buffer->clear();
+        return;
+    }
+
+    mCompileInfo->calcCompileSourceForVariation(getShaderType(), p_buffer, cCompileTarget, variation_map);
+}
+
 void Shader::setBinary(const void* binary)
 {
     mBinary = binary;
@@ -46,6 +46,19 @@ void ShaderCompileInfo::pushBackVariation(const std::string& name, const std::st
 }
 
 void ShaderCompileInfo::calcCompileSource(ShaderType type, std::string* p_buffer, Target target, bool) const
+{
+    calcCompileSource_(type, p_buffer, target, mVariationMap);
+
+    if (mRawText)
+        mRawText->assign(*p_buffer);
+}
+
+void ShaderCompileInfo::calcCompileSourceForVariation(ShaderType type, std::string* p_buffer, Target target, const std::unordered_map<std::string, const std::string>& variation_map) const
+{
+    calcCompileSource_(type, p_buffer, target, variation_map);
+}
+
+void ShaderCompileInfo::calcCompileSource_(ShaderType type, std::string* p_buffer, Target target, const std::unordered_map<std::string, const std::string>& variation_map) const
 {
     RIO_ASSERT(p_buffer != nullptr);
 
@@ -122,27 +135,17 @@ void ShaderCompileInfo::calcCompileSource(ShaderType type, std::string* p_buffer
     p_buffer->append(cComments[1]);
     p_buffer->append(text, text_start_pos);
 
-    if (mMacroMap.size() > 0)
+    if (mMacroMap.size() > 0 || variation_map.size() > 0)
     {
         detail::ShaderTextUtil::replaceMacro(
             p_buffer,
-            mMacroMap
-        );
-    }
-
-    if (mVariationMap.size() > 0)
-    {
-        detail::ShaderTextUtil::replaceMacro(
-            p_buffer,
-            mVariationMap
+            mMacroMap,
+            variation_map
         );
     }
 
     ReplaceSubstr(*p_buffer, "[##n]" , "[n]" );
     ReplaceSubstr(*p_buffer, "##n##.", "##n.");
-
-    if (mRawText)
-        mRawText->assign(*p_buffer);
 }
 
 }
@@ -1,72 +1,7 @@
 #include <common/aglShaderLocation.h>
 #include <common/aglShaderProgram.h>
 
-#if RIO_IS_CAFE
-
-namespace {
-
-static inline GX2SamplerVar*
-GX2GetVertexSamplerVar(const GX2VertexShader* shader,
-                       const char* name)
-{
-    for (u32 i = 0; i < shader->samplerVarCount; i++)
-    {
-       if (strcmp(shader->samplerVars[i].name, name) == 0)
-           return &shader->samplerVars[i];
-    }
-
-    return nullptr;
-}
-
-static inline GX2SamplerVar*
-GX2GetGeometrySamplerVar(const GX2GeometryShader* shader,
-                         const char* name)
-{
-    for (u32 i = 0; i < shader->samplerVarCount; i++)
-    {
-       if (strcmp(shader->samplerVars[i].name, name) == 0)
-           return &shader->samplerVars[i];
-    }
-
-    return nullptr;
-}
-
-static inline s32
-GX2GetVertexUniformVarOffset(const GX2VertexShader* shader,
-                             const char* name)
-{
-    GX2UniformVar* uniform_var = GX2GetVertexUniformVar(shader, name);
-    if (!uniform_var)
-        return -1;
-
-    return (s32)uniform_var->offset;
-}
-
-static inline s32
-GX2GetPixelUniformVarOffset(const GX2PixelShader* shader,
-                            const char* name)
-{
-    GX2UniformVar* uniform_var = GX2GetPixelUniformVar(shader, name);
-    if (!uniform_var)
-        return -1;
-
-    return (s32)uniform_var->offset;
-}
-
-static inline s32
-GX2GetGeometryUniformVarOffset(const GX2GeometryShader* shader,
-                               const char* name)
-{
-    GX2UniformVar* uniform_var = GX2GetGeometryUniformVar(shader, name);
-    if (!uniform_var)
-        return -1;
-
-    return (s32)uniform_var->offset;
-}
-
-}
-
-#elif RIO_IS_WIN
+#if RIO_IS_WIN
 
 #include <detail/aglShaderHolder.h>
 
@@ -84,108 +19,98 @@ void GX2SetPixelUniformReg(u32 offset, u32 count, const void* values)
     agl::detail::ShaderHolder::instance()->mPsCfile.setSubData(values, offset * 4, count * 4);
 }
 
-#include <sstream>
+#include <cstdio>
+#include <string>
 
-namespace {
-
-static inline s32
-GetVertexAttribLocation(const rio::Shader& shader, const GX2VertexShader* p_shader, const char* name)
-{
-    for (u32 i = 0; i < p_shader->numAttribs; i++)
-    {
-        if (std::strcmp(p_shader->attribVars[i].name, name) == 0)
-        {
-            std::ostringstream attribNameStrm;
-            attribNameStrm << name << "_0_0";
-            return shader.getVertexAttribLocation(attribNameStrm.str().c_str());
-        }
-    }
+#endif // RIO_IS_WIN
 
-    return -1;
-}
+#if RIO_IS_CAFE || RIO_IS_WIN
 
-static inline GX2UniformVar*
-GX2GetVertexUniformVar(const GX2VertexShader* shader, const char* name)
-{
-    RIO_ASSERT(shader);
-    RIO_ASSERT(name);
+namespace {
 
-    for (u32 i = 0; i < shader->numUniforms; i++)
-       if (std::strcmp(shader->uniformVars[i].name, name) == 0)
-           return &(shader->uniformVars[i]);
+typedef agl::detail::ShaderSymbolTable ShaderSymbolTable;
 
-    return nullptr;
-}
+// The variables are looked up through the symbol tables of the program instead of by linear name scans
 
+template <typename T>
 static inline s32
-GX2GetVertexUniformVarOffset(const GX2VertexShader* shader, const char* name)
+SearchUniformVarOffset(const T* p_shader, const ShaderSymbolTable* p_table, const char* name)
 {
-    RIO_ASSERT(shader);
-    RIO_ASSERT(name);
+    if (!p_shader)
+        return -1;
 
-    GX2UniformVar* uniform = GX2GetVertexUniformVar(shader, name);
-    if (!uniform)
+    s32 index = p_table->search(ShaderSymbolTable::cKind_UniformVar, name);
+    if (index == -1)
         return -1;
 
-    return s32(uniform->offset);
+    return s32(p_shader->uniformVars[index].offset);
 }
 
-static inline GX2UniformVar*
-GX2GetPixelUniformVar(const GX2PixelShader* shader, const char* name)
+#if RIO_IS_CAFE
+
+template <typename T>
+static inline s32
+SearchUniformBlockOffset(const T* p_shader, const ShaderSymbolTable* p_table, const char* name)
 {
-    RIO_ASSERT(shader);
-    RIO_ASSERT(name);
+    if (!p_shader)
+        return -1;
 
-    for (u32 i = 0; i < shader->numUniforms; i++)
-       if (std::strcmp(shader->uniformVars[i].name, name) == 0)
-           return &(shader->uniformVars[i]);
+    s32 index = p_table->search(ShaderSymbolTable::cKind_UniformBlock, name);
+    if (index == -1)
+        return -1;
 
-    return nullptr;
+    return s32(p_shader->uniformBlocks[index].offset);
 }
 
+template <typename T>
 static inline s32
-GX2GetPixelUniformVarOffset(const GX2PixelShader* shader, const char* name)
+SearchSamplerVarLocation(const T* p_shader, const ShaderSymbolTable* p_table, const char* name)
 {
-    RIO_ASSERT(shader);
-    RIO_ASSERT(name);
+    if (!p_shader)
+        return -1;
 
-    GX2UniformVar* uniform = GX2GetPixelUniformVar(shader, name);
-    if (!uniform)
+    s32 index = p_table->search(ShaderSymbolTable::cKind_SamplerVar, name);
+    if (index == -1)
         return -1;
 
-    return s32(uniform->offset);
+    return s32(p_shader->samplerVars[index].location);
 }
 
-static inline GX2UniformVar*
-GX2GetGeometryUniformVar(const GX2GeometryShader* shader, const char* name)
+static inline s32
+SearchAttribVarLocation(const GX2VertexShader* p_shader, const ShaderSymbolTable* p_table, const char* name)
 {
-    RIO_ASSERT(shader);
-    RIO_ASSERT(name);
+    if (!p_shader)
+        return -1;
 
-    for (u32 i = 0; i < shader->numUniforms; i++)
-       if (std::strcmp(shader->uniformVars[i].name, name) == 0)
-           return &(shader->uniformVars[i]);
+    s32 index = p_table->search(ShaderSymbolTable::cKind_AttribVar, name);
+    if (index == -1)
+        return -1;
 
-    return nullptr;
+    return s32(p_shader->attribVars[index].location);
 }
 
+#elif RIO_IS_WIN
+
 static inline s32
-GX2GetGeometryUniformVarOffset(const GX2GeometryShader* shader, const char* name)
+GetVertexAttribLocation(const rio::Shader& shader, const GX2VertexShader* p_shader, const ShaderSymbolTable* p_table, const char* name)
 {
-    RIO_ASSERT(shader);
-    RIO_ASSERT(name);
-
-    GX2UniformVar* uniform = GX2GetGeometryUniformVar(shader, name);
-    if (!uniform)
+    if (!p_shader || p_table->search(ShaderSymbolTable::cKind_AttribVar, name) == -1)
         return -1;
 
-    return s32(uniform->offset);
-}
+    // Name given to the attribute by the decompiler
+    char attrib_name[256];
+    if (std::snprintf(attrib_name, sizeof(attrib_name), "%s_0_0", name) < s32(sizeof(attrib_name)))
+        return shader.getVertexAttribLocation(attrib_name);
 
+    return shader.getVertexAttribLocation((std::string(name) + "_0_0").c_str());
 }
 
 #endif
 
+}
+
+#endif // RIO_IS_CAFE || RIO_IS_WIN
+
 namespace agl {
 
 void UniformLocation::search(const ShaderProgram& program)
@@ -206,14 +131,9 @@ void UniformLocation::search(const ShaderProgram& program)
     if (mBinary) {
 #endif // RIO_IS_WIN
 
-    if (program.getVertexShaderBinary())
-        mVS = GX2GetVertexUniformVarOffset(program.getVertexShaderBinary(), getName());
-
-    if (program.getFragmentShaderBinary())
-        mFS = GX2GetPixelUniformVarOffset(program.getFragmentShaderBinary(), getName());
-
-    if (program.getGeometryShaderBinary())
-        mGS = GX2GetGeometryUniformVarOffset(program.getGeometryShaderBinary(), getName());
+    mVS = SearchUniformVarOffset(program.getVertexShaderBinary(), program.getVertexShaderSymbolTable(), getName());
+    mFS = SearchUniformVarOffset(program.getFragmentShaderBinary(), program.getFragmentShaderSymbolTable(), getName());
+    mGS = SearchUniformVarOffset(program.getGeometryShaderBinary(), program.getGeometryShaderSymbolTable(), getName());
 
 #if RIO_IS_WIN
     } else {
@@ -236,27 +156,9 @@ void UniformBlockLocation::search(const ShaderProgram& program)
     mGS = -1;
 
 #if RIO_IS_CAFE
-    const GX2VertexShader* vertex_shader = program.getVertexShaderBinary();
-    if (vertex_shader)
-    {
-        GX2UniformBlock* uniform_block = GX2GetVertexUniformBlock(vertex_shader, getName());
-        if (uniform_block)
-            mVS = uniform_block->offset;
-    }
-    const GX2PixelShader* pixel_shader = program.getFragmentShaderBinary();
-    if (pixel_shader)
-    {
-        GX2UniformBlock* uniform_block = GX2GetPixelUniformBlock(pixel_shader, getName());
-        if (uniform_block)
-            mFS = uniform_block->offset;
-    }
-    const GX2GeometryShader* geometry_shader = program.getGeometryShaderBinary();
-    if (geometry_shader)
-    {
-        GX2UniformBlock* uniform_block = GX2GetGeometryUniformBlock(geometry_shader, getName());
-        if (uniform_block)
-            mGS = uniform_block->offset;
-    }
+    mVS = SearchUniformBlockOffset(program.getVertexShaderBinary(), program.getVertexShaderSymbolTable(), getName());
+    mFS = SearchUniformBlockOffset(program.getFragmentShaderBinary(), program.getFragmentShaderSymbolTable(), getName());
+    mGS = SearchUniformBlockOffset(program.getGeometryShaderBinary(), program.getGeometryShaderSymbolTable(), getName());
 #elif RIO_IS_WIN
     const rio::Shader* p_shader_rio = program.getShaderRIO();
     RIO_ASSERT(p_shader_rio);
@@ -277,27 +179,9 @@ void SamplerLocation::search(const ShaderProgram& program)
     mGS = -1;
 
 #if RIO_IS_CAFE
-    const GX2VertexShader* vertex_shader = program.getVertexShaderBinary();
-    if (vertex_shader)
-    {
-        GX2SamplerVar* sampler_var = GX2GetVertexSamplerVar(vertex_shader, getName());
-        if (sampler_var)
-            mVS = sampler_var->location;
-    }
-    const GX2PixelShader* pixel_shader = program.getFragmentShaderBinary();
-    if (pixel_shader)
-    {
-        GX2SamplerVar* sampler_var = GX2GetPixelSamplerVar(pixel_shader, getName());
-        if (sampler_var)
-            mFS = sampler_var->location;
-    }
-    const GX2GeometryShader* geometry_shader = program.getGeometryShaderBinary();
-    if (geometry_shader)
-    {
-        GX2SamplerVar* sampler_var = GX2GetGeometrySamplerVar(geometry_shader, getName());
-        if (sampler_var)
-            mGS = sampler_var->location;
-    }
+    mVS = SearchSamplerVarLocation(program.getVertexShaderBinary(), program.getVertexShaderSymbolTable(), getName());
+    mFS = SearchSamplerVarLocation(program.getFragmentShaderBinary(), program.getFragmentShaderSymbolTable(), getName());
+    mGS = SearchSamplerVarLocation(program.getGeometryShaderBinary(), program.getGeometryShaderSymbolTable(), getName());
 #elif RIO_IS_WIN
     const rio::Shader* p_shader_rio = program.getShaderRIO();
     RIO_ASSERT(p_shader_rio);
@@ -314,15 +198,12 @@ void AttributeLocation::search(const ShaderProgram& program)
 #endif // RIO_IS_WIN
 
 #if RIO_IS_CAFE
-    // if (program.getVertexShaderBinary())
-        mVS = GX2GetVertexAttribVarLocation(program.getVertexShaderBinary(), getName());
-    // else
-    //     mVS = -1;
+    mVS = SearchAttribVarLocation(program.getVertexShaderBinary(), program.getVertexShaderSymbolTable(), getName());
 #elif RIO_IS_WIN
     const rio::Shader* p_shader_rio = program.getShaderRIO();
     RIO_ASSERT(p_shader_rio);
     if (mBinary)
-        mVS = GetVertexAttribLocation(*p_shader_rio, program.getVertexShaderBinary(), getName());
+        mVS = GetVertexAttribLocation(*p_shader_rio, program.getVertexShaderBinary(), program.getVertexShaderSymbolTable(), getName());
     else
         mVS = p_shader_rio->getVertexAttribLocation(getName());
 #else
@@ -7,9 +7,44 @@
 
 #include <cstring>
 
+#if !RIO_IS_CAFE
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif // RIO_IS_CAFE
+
 #if RIO_IS_WIN
 #include <detail/aglShaderHolder.h>
+#include <detail/aglShaderProgramCache.h>
 #include <graphics/win/ShaderUtil.h>
+#include <misc/gl/rio_GL.h>
+#endif // RIO_IS_WIN
+
+#if RIO_IS_WIN
+
+namespace {
+
+// Smallest program giving rio::Shader a program object to restore a cached binary into
+static const char* const cPlaceholderVertexSrc =
+    "#version 330\n"
+    "void main() { gl_Position = vec4(0.0); }\n";
+
+static const char* const cPlaceholderFragmentSrc =
+    "#version 330\n"
+    "void main() { }\n";
+
+GLuint GetProgramHandle(const rio::Shader& shader)
+{
+    shader.bind();
+
+    GLint program = 0;
+    RIO_GL_CALL(glGetIntegerv(GL_CURRENT_PROGRAM, &program));
+    return program;
+}
+
+}
+
 #endif // RIO_IS_WIN
 
 namespace agl {
@@ -38,12 +73,16 @@ ShaderProgram::ShaderProgram()
 #if RIO_IS_WIN
     , mVsCfileBlockIdx(-1)
     , mPsCfileBlockIdx(-1)
+    , mPushLocation({ u32(-1), u32(-1), u32(-1), u32(-1), u32(-1), u32(-1), u32(-1) })
+    , mIsPushUploaded(false)
 #endif // RIO_IS_WIN
 {
 }
 
 ShaderProgram::~ShaderProgram()
 {
+    detail::BoundStateCache::invalidateShaderProgram();
+
     cleanUp();
 
     destroyAttribute();
@@ -116,13 +155,26 @@ ShaderMode ShaderProgram::activate(ShaderMode current_mode, bool use_dl) const
     updateCompile();
 #endif
 
+    const bool bind = detail::BoundStateCache::bindShaderProgram(this);
+
 #if RIO_IS_CAFE
+    if (!bind)
+        return current_mode;
+
     if (use_dl && !mDisplayList.isEmpty())
         mDisplayList.call();
     else
-#endif // RIO_IS_CAFE
+#elif RIO_IS_WIN
+    // The push constants are uploaded again even if the program is already bound
+    if (bind || !mIsPushUploaded)
+#endif
         setShaderGX2_();
 
+#if RIO_IS_WIN
+    // The CFILE binding points are global and may have been rebound by any other program, so they are not cached
+    bindCfile_();
+#endif // RIO_IS_WIN
+
     return current_mode;
 }
 
@@ -156,6 +208,49 @@ const Shader* ShaderProgram::getShader(ShaderType type) const
     }
 }
 
+#if RIO_IS_CAFE || RIO_IS_WIN
+
+const detail::ShaderSymbolTable* ShaderProgram::getVertexShaderSymbolTable() const
+{
+    const GX2VertexShader* p_shader = getVertexShaderBinary();
+    if (p_shader == nullptr)
+        return nullptr;
+
+    detail::ShaderSymbolTable& table = mSymbolTable[cShaderType_Vertex];
+    if (!table.isBuilt(p_shader))
+        table.build(p_shader);
+
+    return &table;
+}
+
+const detail::ShaderSymbolTable* ShaderProgram::getFragmentShaderSymbolTable() const
+{
+    const GX2PixelShader* p_shader = getFragmentShaderBinary();
+    if (p_shader == nullptr)
+        return nullptr;
+
+    detail::ShaderSymbolTable& table = mSymbolTable[cShaderType_Fragment];
+    if (!table.isBuilt(p_shader))
+        table.build(p_shader);
+
+    return &table;
+}
+
+const detail::ShaderSymbolTable* ShaderProgram::getGeometryShaderSymbolTable() const
+{
+    const GX2GeometryShader* p_shader = getGeometryShaderBinary();
+    if (p_shader == nullptr)
+        return nullptr;
+
+    detail::ShaderSymbolTable& table = mSymbolTable[cShaderType_Geometry];
+    if (!table.isBuilt(p_shader))
+        table.build(p_shader);
+
+    return &table;
+}
+
+#endif // RIO_IS_CAFE || RIO_IS_WIN
+
 void ShaderProgram::createAttribute(s32 num)
 {
     RIO_ASSERT(mAttributeLocation.size() == 0);
@@ -266,26 +361,123 @@ void ShaderProgram::setSamplerLocationName(s32 index, const char* name)
 
 u32 ShaderProgram::setUpAllVariation()
 {
-    u32 ret;
+    ShaderProgram* program = this;
+    return setUpAllVariation(&program, 1);
+}
 
-    if (getVariation_())
+u32 ShaderProgram::setUpAllVariation(ShaderProgram* const* programs, s32 num)
+{
+    // Originals followed by their variations, in the order they are validated
+    std::vector<const ShaderProgram*> targets;
+
+    for (s32 i = 0; i < num; i++)
+    {
+        const VariationBuffer* variation_buffer = programs[i]->getVariation_();
+        if (variation_buffer)
+        {
+            targets.push_back(variation_buffer->mpOriginal);
+            for (Buffer<ShaderProgram>::constIterator it = variation_buffer->mProgram.begin(), it_end = variation_buffer->mProgram.end(); it != it_end; ++it)
+                targets.push_back(&(*it));
+        }
+        else
+        {
+            targets.push_back(programs[i]);
+        }
+    }
+
+    const s32 target_num = targets.size();
+    u32 ret = 0;
+
+#if RIO_IS_CAFE
+    for (s32 i = 0; i < target_num; i++)
+    {
+        ret = targets[i]->validate_();
+        if (ret != 0)
+            break;
+    }
+#else
+    // The calling thread keeps one core for compiling
+    const s32 thread_num = std::min<s32>(std::max<s32>(std::thread::hardware_concurrency(), 2) - 1, target_num - 1);
+    if (thread_num <= 0)
+    {
+        for (s32 i = 0; i < target_num; i++)
+        {
+            ret = targets[i]->validate_();
+            if (ret != 0)
+                break;
+        }
+
+        return ret;
+    }
+
+    // Workers generate the compile sources (or decompile binaries) ahead of the calling thread, at most slot_num targets in advance
+    const s32 slot_num = thread_num * 2;
+    std::vector<CompileSource> slots(slot_num);
+    std::vector<bool> ready(slot_num, false);
+
+    std::mutex mutex;
+    std::condition_variable cond_ready;
+    std::condition_variable cond_free;
+    s32 next = 0;
+    s32 consumed = 0;
+    bool is_stopped = false;
+
+    auto worker = [&]()
     {
-        ret = getVariation_()->mpOriginal->validate_();
-        if (ret == 0)
+        while (true)
         {
-            for (Buffer<ShaderProgram>::iterator it = getVariation_()->mProgram.begin(), it_end = getVariation_()->mProgram.end(); it != it_end; ++it)
+            s32 index;
             {
-                ret = it->validate_();
-                if (ret != 0)
-                    break;
+                std::unique_lock<std::mutex> lock(mutex);
+                cond_free.wait(lock, [&]() { return is_stopped || next >= target_num || next < consumed + slot_num; });
+                if (is_stopped || next >= target_num)
+                    return;
+
+                index = next++;
             }
+
+            targets[index]->prepareValidate_(&slots[index % slot_num]);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ready[index % slot_num] = true;
+            }
+            cond_ready.notify_all();
         }
-    }
-    else
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(thread_num);
+    for (s32 i = 0; i < thread_num; i++)
+        threads.emplace_back(worker);
+
+    for (s32 i = 0; i < target_num; i++)
     {
-        ret = validate_();
+        const s32 slot = i % slot_num;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cond_ready.wait(lock, [&]() { return bool(ready[slot]); });
+        }
+
+        const CompileSource& source = slots[slot];
+        ret = targets[i]->validate_(source.is_valid ? &source : nullptr);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ready[slot] = false;
+            consumed = i + 1;
+            is_stopped = ret != 0;
+        }
+        cond_free.notify_all();
+
+        if (ret != 0)
+            break;
     }
 
+    for (std::thread& thread : threads)
+        thread.join();
+#endif // RIO_IS_CAFE
+
     return ret;
 }
 
@@ -396,22 +588,25 @@ void ShaderProgram::updateSamplerLocation() const
         it->search(*this);
 }
 
-u32 ShaderProgram::validate_() const
+u32 ShaderProgram::validate_(const CompileSource* p_source) const
 {
     if (mFlag.isOn(2))
     {
         mFlag.reset(2);
-        return forceValidate_();
+        return forceValidate_(p_source);
     }
 
     return 0;
 }
 
-u32 ShaderProgram::forceValidate_() const
+u32 ShaderProgram::forceValidate_(const CompileSource* p_source) const
 {
     u32 ret = 0;
     bool compile_source = mFlag.isOn(1);
 
+    // The program may be rebuilt or rebound below
+    detail::BoundStateCache::invalidateShaderProgram();
+
     setUpForVariation_();
 
 #if RIO_IS_WIN
@@ -455,15 +650,15 @@ u32 ShaderProgram::forceValidate_() const
     }
     else
 #endif // RIO_IS_WIN
-    if (mVertexShader.setUp(compile_source, mFlag.isOn(8)) != 0)
+    if (mVertexShader.setUp(compile_source, mFlag.isOn(8), p_source ? &p_source->text[cShaderType_Vertex] : nullptr) != 0)
     {
         ret = 1;
     }
-    else if (mFragmentShader.setUp(compile_source, mFlag.isOn(8)) != 0)
+    else if (mFragmentShader.setUp(compile_source, mFlag.isOn(8), p_source ? &p_source->text[cShaderType_Fragment] : nullptr) != 0)
     {
         ret = 2;
     }
-    else if (mGeometryShader.setUp(compile_source, mFlag.isOn(8)) == 1)
+    else if (mGeometryShader.setUp(compile_source, mFlag.isOn(8), p_source ? &p_source->text[cShaderType_Geometry] : nullptr) == 1)
     {
         ret = 3;
     }
@@ -486,7 +681,7 @@ u32 ShaderProgram::forceValidate_() const
             const std::string* p_frag_src = p_frag_compile_info->getRawText();
             RIO_ASSERT(p_frag_src != nullptr);
 
-            mShader.load(p_vert_src->c_str(), p_frag_src->c_str());
+            loadShaderRIO_(*p_vert_src, *p_frag_src);
 
             mVsCfileBlockIdx = -1;
             mPsCfileBlockIdx = -1;
@@ -533,6 +728,9 @@ u32 ShaderProgram::forceValidate_() const
         updateUniformBlockLocation();
         updateAttributeLocation();
         updateSamplerLocation();
+#if RIO_IS_WIN
+        updatePushLocation_();
+#endif // RIO_IS_WIN
     }
 
     // TODO
@@ -542,6 +740,54 @@ u32 ShaderProgram::forceValidate_() const
     return ret;
 }
 
+void ShaderProgram::prepareValidate_(CompileSource* p_source) const
+{
+    p_source->is_valid = isCompileSourceRequired_();
+    if (p_source->is_valid)
+    {
+        calcCompileSource_(p_source);
+        return;
+    }
+
+#if RIO_IS_WIN
+    // Run the decompilers here, so that decompileGsh() in forceValidate_() only reads their output from the cache
+    if (mFlag.isOn(2) && mFlag.isOn(1) && isUseBinaryProgram() &&
+        mVertexShader.getBinary() && mFragmentShader.getBinary())
+    {
+        ShaderUtil::cacheGsh(*mVertexShader.getBinary(), *mFragmentShader.getBinary());
+    }
+#endif // RIO_IS_WIN
+}
+
+bool ShaderProgram::isCompileSourceRequired_() const
+{
+    // Only variations are generated ahead, as their compile info is shared and holds the variation macros of the last one set up
+    if (!getVariation_() || mFlag.isOff(2) || mFlag.isOff(1))
+        return false;
+
+#if RIO_IS_WIN
+    if (isUseBinaryProgram())
+        return false;
+#endif // RIO_IS_WIN
+
+    return true;
+}
+
+void ShaderProgram::calcCompileSource_(CompileSource* p_source) const
+{
+    RIO_ASSERT(getVariation_() != nullptr);
+
+    const ShaderProgram* program = getVariation_()->mpOriginal;
+
+    std::unordered_map<std::string, std::string> macro_map;
+    getVariation_()->getMacroAndValueArray(mVariationID, &macro_map);
+
+    const std::unordered_map<std::string, const std::string> variation_map(macro_map.begin(), macro_map.end());
+
+    for (s32 type = 0; type < cShaderType_Num; type++)
+        program->getShader(ShaderType(type))->calcCompileSource(&p_source->text[type], variation_map);
+}
+
 void ShaderProgram::setUpForVariation_() const
 {
     if (!getVariation_())
@@ -563,10 +809,95 @@ void ShaderProgram::setUpForVariation_() const
         for (const auto& itr_variation : macro_map)
             compile_info->pushBackVariation(itr_variation.first, itr_variation.second);
 
-        getShader(ShaderType(type))->setCompileInfo(compile_info);
+        // The original's shaders already point to it, and may be read by workers of setUpAllVariation()
+        if (program != this)
+            getShader(ShaderType(type))->setCompileInfo(compile_info);
+    }
+}
+
+#if RIO_IS_WIN
+
+void ShaderProgram::loadShaderRIO_(const std::string& vertex_src, const std::string& fragment_src) const
+{
+    if (!detail::ShaderProgramCache::isEnabled())
+    {
+        mShader.load(vertex_src.c_str(), fragment_src.c_str());
+        return;
+    }
+
+    const std::string& key = detail::ShaderProgramCache::calcKey(ShaderCompileInfo::cTarget_GX2, vertex_src, fragment_src);
+
+    if (loadShaderRIOFromCache_(key))
+        return;
+
+    mShader.load(vertex_src.c_str(), fragment_src.c_str());
+    saveShaderRIOToCache_(key);
+}
+
+bool ShaderProgram::loadShaderRIOFromCache_(const std::string& key) const
+{
+    u32 format;
+    std::string binary;
+    if (!detail::ShaderProgramCache::read(key, &format, &binary))
+        return false;
+
+    mShader.load(cPlaceholderVertexSrc, cPlaceholderFragmentSrc);
+
+    const GLuint program = GetProgramHandle(mShader);
+    RIO_GL_CALL(glProgramBinary(program, format, binary.data(), binary.size()));
+
+    GLint status = GL_FALSE;
+    RIO_GL_CALL(glGetProgramiv(program, GL_LINK_STATUS, &status));
+    if (status == GL_TRUE)
+        return true;
+
+    // Binary from another driver or GPU; compile normally and replace it
+    mShader.unload();
+    detail::ShaderProgramCache::remove(key);
+    return false;
+}
+
+void ShaderProgram::updatePushLocation_() const
+{
+    mIsPushUploaded = false;
+
+    if (!mShader.isLoaded())
+    {
+        mPushLocation = { u32(-1), u32(-1), u32(-1), u32(-1), u32(-1), u32(-1), u32(-1) };
+        return;
     }
+
+    mPushLocation.ps_alpha_func         = mShader.getFragmentUniformLocation("PS_PUSH.alphaFunc");
+    mPushLocation.ps_item_id            = mShader.getFragmentUniformLocation("PS_PUSH.uItemID");
+    mPushLocation.ps_is_selected        = mShader.getFragmentUniformLocation("PS_PUSH.uIsSelected");
+    mPushLocation.ps_needs_premultiply  = mShader.getFragmentUniformLocation("PS_PUSH.needsPremultiply");
+    mPushLocation.vs_pos_mul_add        = mShader.getVertexUniformLocation("VS_PUSH.posMulAdd");
+    mPushLocation.vs_z_space_mul        = mShader.getVertexUniformLocation("VS_PUSH.zSpaceMul");
+    mPushLocation.vs_point_size         = mShader.getVertexUniformLocation("VS_PUSH.pointSize");
+}
+
+void ShaderProgram::saveShaderRIOToCache_(const std::string& key) const
+{
+    if (!mShader.isLoaded())
+        return;
+
+    const GLuint program = GetProgramHandle(mShader);
+
+    GLint size = 0;
+    RIO_GL_CALL(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size));
+    if (size <= 0)
+        return;
+
+    std::string binary(size, '\0');
+    GLenum format = 0;
+    RIO_GL_CALL(glGetProgramBinary(program, size, &size, &format, binary.data()));
+    binary.resize(size);
+
+    detail::ShaderProgramCache::write(key, format, binary);
 }
 
+#endif // RIO_IS_WIN
+
 void ShaderProgram::setShaderGX2_() const
 {
 #if RIO_IS_CAFE
@@ -581,18 +912,33 @@ void ShaderProgram::setShaderGX2_() const
 #elif RIO_IS_WIN
     mShader.bind();
 
-    mShader.setUniform(7u,      u32(-1), mShader.getFragmentUniformLocation("PS_PUSH.alphaFunc"));
-    mShader.setUniform(u32(-1), u32(-1), mShader.getFragmentUniformLocation("PS_PUSH.uItemID"));
-    mShader.setUniform(0,       u32(-1), mShader.getFragmentUniformLocation("PS_PUSH.uIsSelected"));
-
-    if (isUseBinaryProgram())
+    // Uniform values are kept by the program, so they only need to be set again after it is relinked or handed out
+    if (!mIsPushUploaded)
     {
-        mShader.setUniform(rio::BaseVec4f{ 1.0f, -1.0f, 0.0f, 0.0f }, mShader.getVertexUniformLocation("VS_PUSH.posMulAdd"), u32(-1));
-        mShader.setUniform(rio::BaseVec4f{ 0.0f,  1.0f, 1.0f, 1.0f }, mShader.getVertexUniformLocation("VS_PUSH.zSpaceMul"), u32(-1));
-        mShader.setUniform(1.0f,                                      mShader.getVertexUniformLocation("VS_PUSH.pointSize"), u32(-1));
+        mShader.setUniform(7u,      u32(-1), mPushLocation.ps_alpha_func);
+        mShader.setUniform(u32(-1), u32(-1), mPushLocation.ps_item_id);
+        mShader.setUniform(0,       u32(-1), mPushLocation.ps_is_selected);
+
+        if (isUseBinaryProgram())
+        {
+            mShader.setUniform(rio::BaseVec4f{ 1.0f, -1.0f, 0.0f, 0.0f }, mPushLocation.vs_pos_mul_add, u32(-1));
+            mShader.setUniform(rio::BaseVec4f{ 0.0f,  1.0f, 1.0f, 1.0f }, mPushLocation.vs_z_space_mul, u32(-1));
+            mShader.setUniform(1.0f,                                      mPushLocation.vs_point_size, u32(-1));
+
+            mShader.setUniform(0u, u32(-1), mPushLocation.ps_needs_premultiply);
+        }
 
-        mShader.setUniform(0u, u32(-1), mShader.getFragmentUniformLocation("PS_PUSH.needsPremultiply"));
+        mIsPushUploaded = mShader.isLoaded();
+    }
+#endif
+}
 
+#if RIO_IS_WIN
+
+void ShaderProgram::bindCfile_() const
+{
+    if (isUseBinaryProgram())
+    {
         if (mVsCfileBlockIdx != -1)
         {
             detail::ShaderHolder::instance()->mVsCfile.bind(mVsCfileBlockIdx);
@@ -603,9 +949,10 @@ void ShaderProgram::setShaderGX2_() const
             detail::ShaderHolder::instance()->mPsCfile.bind(mPsCfileBlockIdx);
         }
     }
-#endif
 }
 
+#endif // RIO_IS_WIN
+
 void ShaderProgram::cleanUp()
 {
     if (mFlag.isOn(1))
@@ -1,5 +1,4 @@
 #include <common/aglShaderProgramArchive.h>
-#include <detail/aglShaderTextUtil.h>
 
 #include <cstring>
 
@@ -106,7 +105,7 @@ void ShaderProgramArchive::destroyResFile_()
         mProgramEx.freeBuffer();
 
         mSourceVec.clear();
-        mSourceMap.clear();
+        mSourceIndexMap.clear();
     }
     mResText = nullptr;
 }
@@ -256,6 +255,43 @@ void ShaderProgramArchive::updateCompileInfo()
         source.mFlag.reset(1);
 }
 
+bool ShaderProgramArchive::updateSourceText(const char* name, const std::string& text)
+{
+    const auto& itr_source = mSourceIndexMap.find(name);
+    if (itr_source == mSourceIndexMap.end())
+        return false;
+
+    ShaderSource& source = mSourceVec[itr_source->second];
+
+    source.mOriginalText = text;
+    source.analyzeInclude();
+    source.mFlag.set(1);
+
+    updateSourceDependent_();
+
+    // Raw texts only splice the original text of included sources, so only direct dependents change
+    for (s32 index : source.mDependent)
+        mSourceVec[index].mFlag.set(1);
+
+    return true;
+}
+
+void ShaderProgramArchive::updateSourceDependent_()
+{
+    for (ShaderSource& source : mSourceVec)
+        source.mDependent.clear();
+
+    for (const ShaderSource& source : mSourceVec)
+    {
+        for (const ShaderSource::Include& include : source.mInclude)
+        {
+            std::vector<s32>& dependent = mSourceVec[include.mSourceIndex].mDependent;
+            if (dependent.empty() || dependent.back() != source.mIndex)
+                dependent.push_back(source.mIndex);
+        }
+    }
+}
+
 void ShaderProgramArchive::setResShaderArchive_(ResShaderArchive res_archive)
 {
     destroyResFile_();
@@ -279,7 +315,7 @@ void ShaderProgramArchive::setResShaderArchive_(ResShaderArchive res_archive)
     }
 
     mSourceVec.resize(mResText.getResShaderSourceNum());
-    mSourceMap.reserve(mSourceVec.size());
+    mSourceIndexMap.reserve(mSourceVec.size());
 
     mProgramEx.allocBuffer(mProgram.size());
 
@@ -321,10 +357,15 @@ void ShaderProgramArchive::setResShaderArchive_(ResShaderArchive res_archive)
 
     for (const ShaderSource& source : mSourceVec)
     {
-        [[maybe_unused]] const auto& itr = mSourceMap.try_emplace(source.mOriginalName, source.mOriginalText);
+        [[maybe_unused]] const auto& itr = mSourceIndexMap.try_emplace(source.mOriginalName, source.mIndex);
         RIO_ASSERT(itr.second);
     }
 
+    for (ShaderSource& source : mSourceVec)
+        source.analyzeInclude();
+
+    updateSourceDependent_();
+
     for (ResShaderProgramArray::constIterator it = prog_arr.begin(), it_end = prog_arr.end(); it != it_end; ++it)
     {
         const ResShaderProgram prog(&(*it));
@@ -358,12 +399,20 @@ bool ShaderProgramArchive::setUp_(bool unk)
     for (Buffer<ShaderProgramEx>::iterator it = mProgramEx.begin(), it_end = mProgramEx.end(); it != it_end; ++it)
         it->updateAnalyze();
 
-    for (Buffer<ShaderProgram>::iterator it = mProgram.begin(), it_end = mProgram.end(); it != it_end; ++it)
+    // TODO
+    // for (Buffer<ShaderProgram>::iterator it = mProgram.begin(), it_end = mProgram.end(); it != it_end; ++it)
+    //     it->mpSharedData->_10 = _20;
+
+    if (!unk || _28 <= 1)
     {
-        // TODO
-        // it->mpSharedData->_10 = _20;
+        // Set up all programs at once so that the compile sources of their variations are generated in parallel
+        std::vector<ShaderProgram*> programs;
+        programs.reserve(mProgram.size());
 
-        if ((!unk || _28 <= 1) && it->setUpAllVariation() != 0)
+        for (Buffer<ShaderProgram>::iterator it = mProgram.begin(), it_end = mProgram.end(); it != it_end; ++it)
+            programs.push_back(&(*it));
+
+        if (ShaderProgram::setUpAllVariation(programs.data(), programs.size()) != 0)
             return false;
     }
 
@@ -473,17 +522,70 @@ void ShaderProgramArchive::ShaderSource::initialize(ShaderProgramArchive* archiv
   //detail::RootNode::setNodeMeta(this, "Icon = NOTE");
 }
 
+void ShaderProgramArchive::ShaderSource::analyzeInclude()
+{
+    // Same scan as detail::ShaderTextUtil::createRawText(), done once on the original text
+    // so that expanding only has to splice the included sources at the recorded positions
+
+    const std::string& text = mOriginalText;
+    std::string::size_type text_pos = 0;
+
+    mInclude.clear();
+
+    while (text_pos < text.length())
+    {
+        const std::string::size_type include_directive_begin = text.find_first_of('#', text_pos);
+        if (include_directive_begin == std::string::npos)
+            break;
+
+        text_pos = text.find_first_not_of(" \t\r\n", include_directive_begin + 1, 4);
+        if (text_pos == std::string::npos)
+            break;
+
+        if (text.compare(text_pos, 7, "include", 7) != 0)
+            continue;
+
+        const std::string::size_type include_name_begin = text.find_first_of('\"', text_pos);
+        if (include_name_begin == std::string::npos)
+            continue;
+
+        const std::string::size_type include_directive_end = text.find_first_of('\"', include_name_begin + 1);
+        if (include_directive_end == std::string::npos)
+            continue;
+
+        const auto& itr_source = mpArchive->mSourceIndexMap.find(text.substr(include_name_begin + 1, include_directive_end - (include_name_begin + 1)));
+        if (itr_source == mpArchive->mSourceIndexMap.end())
+            break;
+
+        mInclude.push_back({ include_directive_begin, include_directive_end + 1, itr_source->second });
+
+        text_pos = include_directive_end + 1;
+    }
+}
+
 void ShaderProgramArchive::ShaderSource::expand()
 {
     if (mFlag.isOff(1 << 1))
         return;
 
-    mRawText = mOriginalText;
+    std::string::size_type raw_text_len = mOriginalText.length();
+    for (const Include& include : mInclude)
+        raw_text_len += mpArchive->mSourceVec[include.mSourceIndex].mOriginalText.length() - (include.mEnd - include.mBegin);
+
+    mRawText.clear();
+    mRawText.reserve(raw_text_len);
+
+    std::string::size_type text_pos = 0;
+
+    for (const Include& include : mInclude)
+    {
+        mRawText.append(mOriginalText, text_pos, include.mBegin - text_pos);
+        mRawText.append(mpArchive->mSourceVec[include.mSourceIndex].mOriginalText);
+
+        text_pos = include.mEnd;
+    }
 
-    detail::ShaderTextUtil::createRawText(
-        &mRawText,
-        mpArchive->mSourceMap
-    );
+    mRawText.append(mOriginalText, text_pos, std::string::npos);
 }
 
 }
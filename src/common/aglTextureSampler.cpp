@@ -18,6 +18,11 @@ TextureSampler::TextureSampler(const TextureData& texture_data)
     applyTextureData(texture_data);
 }
 
+TextureSampler::~TextureSampler()
+{
+    detail::BoundStateCache::invalidateTextureSampler();
+}
+
 void TextureSampler::applyTextureData_(const TextureData& texture_data)
 {
     mTextureData = texture_data;
@@ -63,7 +68,12 @@ bool TextureSampler::activate(const SamplerLocation& location, s32 slot) const
 bool TextureSampler::activate(s32 vs, s32 fs, s32 gs, s32 slot) const
 {
     RIO_ASSERT(gs == -1);
-    return mSamplerInner.tryBind(vs, fs, slot != -1 ? slot : 0);
+
+    slot = slot != -1 ? slot : 0;
+    if (!detail::BoundStateCache::bindTextureSampler(this, vs, fs, gs, slot))
+        return true;
+
+    return mSamplerInner.tryBind(vs, fs, slot);
 }
 
 }
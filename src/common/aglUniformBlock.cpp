@@ -35,6 +35,8 @@ static const u8 sTypeInfo[agl::UniformBlock::cType_Num][3] = {
 
 namespace agl {
 
+UniformBlock::Statistics UniformBlock::sStatistics = { };
+
 UniformBlock::UniformBlock()
     : mpHeader(nullptr)
     , mCurrentBuffer(nullptr)
@@ -43,6 +45,8 @@ UniformBlock::UniformBlock()
 #endif // RIO_IS_WIN
     , mBlockSize(0)
     , mFlag(0)
+    , mDirtyBegin(u32(-1))
+    , mDirtyEnd(0)
 {
 }
 
@@ -124,6 +128,8 @@ void UniformBlock::create()
     mpUBO = new rio::UniformBlock(mCurrentBuffer, mBlockSize);
 #endif // RIO_IS_WIN
 
+    setDirtyAll_();
+
     mFlag.set(cFlag_OwnBuffer);
 }
 
@@ -151,6 +157,7 @@ void UniformBlock::destroy()
     mpUBO = nullptr;
 #endif // RIO_IS_WIN
     mBlockSize = 0;
+    clearDirty_();
 
     if (mFlag.isOn(cFlag_OwnHeader))
     {
@@ -174,21 +181,64 @@ void UniformBlock::dcbz() const
     }
 #else
     rio::MemUtil::set(mCurrentBuffer, 0, mBlockSize);
-#if RIO_IS_WIN
-    mpUBO->setData(mCurrentBuffer, mBlockSize);
-#endif // RIO_IS_WIN
 #endif
+
+    // Uploaded by the next flush
+    setDirtyAll_();
 }
 
 void UniformBlock::flush(void* p_memory, bool invalidate_gpu) const
 {
+    flush_(p_memory, invalidate_gpu, true);
+}
+
+void UniformBlock::flushNoSync(void* p_memory, bool invalidate_gpu) const
+{
+    flush_(p_memory, invalidate_gpu, false);
+}
+
+void UniformBlock::resetStatistics()
+{
+    sStatistics = Statistics();
+}
+
+void UniformBlock::flush_(void* p_memory, bool invalidate_gpu, [[maybe_unused]] bool sync) const
+{
+    u32 begin = 0;
+    u32 end = mBlockSize;
+
+    if (p_memory == mCurrentBuffer)
+    {
+        sStatistics.flush_num++;
+        sStatistics.declared_size += mBlockSize;
+
+        if (!isDirty())
+        {
+            sStatistics.skip_num++;
+            return;
+        }
+
+        begin = mDirtyBegin;
+        end = mDirtyEnd;
+        clearDirty_();
+
+        sStatistics.upload_size += end - begin;
+    }
+
+    u8* ptr = static_cast<u8*>(p_memory) + begin;
+    const u32 size = end - begin;
+
 #if RIO_IS_CAFE
-    DCFlushRange(p_memory, mBlockSize);
+    if (sync)
+        DCFlushRange(ptr, size);
+    else
+        DCFlushRangeNoSync(ptr, size);
+
     if (invalidate_gpu)
-        GX2Invalidate(GX2_INVALIDATE_UNIFORM_BLOCK, p_memory, mBlockSize);
+        GX2Invalidate(GX2_INVALIDATE_UNIFORM_BLOCK, ptr, size);
 #elif RIO_IS_WIN
     RIO_ASSERT(p_memory == mCurrentBuffer);
-    mpUBO->setData(mCurrentBuffer, mBlockSize);
+    mpUBO->setSubData(ptr, begin, size);
 #endif
 }
 
@@ -250,6 +300,13 @@ void UniformBlock::setData_(void* p_memory, s32 index, const void* p_data, s32 a
     u8* ptr = (u8*)p_memory + stride_array * array_index * sizeof(u32) + member.mOffset;
     u8 stride = sTypeInfo[member.mType][0];
 
+    if (p_memory == mCurrentBuffer)
+    {
+        // Whole array elements, which also covers the cache lines zeroed below
+        const u32 begin = ptr - mCurrentBuffer;
+        setDirty_(begin, begin + array_num * stride_array * sizeof(u32));
+    }
+
 #if RIO_IS_CAFE
     if ((uintptr_t)ptr % cCPUCacheLineSize == 0)
     {
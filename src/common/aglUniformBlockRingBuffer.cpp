@@ -0,0 +1,183 @@
+#include <common/aglUniformBlockRingBuffer.h>
+#include <misc/rio_MemUtil.h>
+
+#include <algorithm>
+
+#if RIO_IS_CAFE
+#include <cafe.h>
+#elif RIO_IS_WIN
+#include <misc/gl/rio_GL.h>
+#endif
+
+// TODO: Move to the proper headers
+#define ROUNDUP(x, y) (((x) + ((y) - 1)) & ~((y) - 1))
+
+namespace agl {
+
+UniformBlockRingBuffer::UniformBlockRingBuffer()
+    : mpBuffer(nullptr)
+    , mFrameSize(0)
+    , mFrameNum(0)
+    , mFrameIndex(0)
+    , mUsedSize(0)
+    , mAlignment(UniformBlock::cUniformBlockAlignment)
+#if RIO_IS_WIN
+    , mHandle(GL_NONE)
+#endif // RIO_IS_WIN
+    , mStatistics()
+{
+}
+
+UniformBlockRingBuffer::~UniformBlockRingBuffer()
+{
+    destroy();
+}
+
+bool UniformBlockRingBuffer::create(u32 frame_size, s32 frame_num)
+{
+    RIO_ASSERT(mpBuffer == nullptr);
+    RIO_ASSERT(0 < frame_size);
+    RIO_ASSERT(0 < frame_num);
+
+    mAlignment = UniformBlock::cUniformBlockAlignment;
+
+#if RIO_IS_WIN
+    GLint offset_alignment = 0;
+    RIO_GL_CALL(glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offset_alignment));
+    mAlignment = std::max<u32>(mAlignment, offset_alignment);
+#endif // RIO_IS_WIN
+
+    mFrameSize = ROUNDUP(frame_size, mAlignment);
+    mFrameNum = frame_num;
+
+    mpBuffer = static_cast<u8*>(rio::MemUtil::alloc(mFrameSize * mFrameNum, mAlignment));
+    if (mpBuffer == nullptr)
+    {
+        RIO_LOG("UniformBlockRingBuffer::create(): Failed to allocate %u bytes.\n", mFrameSize * mFrameNum);
+        mFrameSize = 0;
+        mFrameNum = 0;
+        return false;
+    }
+
+#if RIO_IS_WIN
+    RIO_GL_CALL(glGenBuffers(1, &mHandle));
+    RIO_ASSERT(mHandle != GL_NONE);
+    RIO_GL_CALL(glBindBuffer(GL_UNIFORM_BUFFER, mHandle));
+    RIO_GL_CALL(glBufferData(GL_UNIFORM_BUFFER, mFrameSize * mFrameNum, nullptr, GL_DYNAMIC_DRAW));
+#endif // RIO_IS_WIN
+
+    mFrameIndex = 0;
+    mUsedSize = 0;
+    mStatistics = Statistics();
+
+    return true;
+}
+
+void UniformBlockRingBuffer::destroy()
+{
+    if (mpBuffer)
+    {
+        rio::MemUtil::free(mpBuffer);
+        mpBuffer = nullptr;
+    }
+
+#if RIO_IS_WIN
+    if (mHandle != GL_NONE)
+    {
+        RIO_GL_CALL(glDeleteBuffers(1, &mHandle));
+        mHandle = GL_NONE;
+    }
+#endif // RIO_IS_WIN
+
+    mFrameSize = 0;
+    mFrameNum = 0;
+    mFrameIndex = 0;
+    mUsedSize = 0;
+}
+
+void UniformBlockRingBuffer::beginFrame()
+{
+    RIO_ASSERT(mpBuffer != nullptr);
+
+    mFrameIndex = (mFrameIndex + 1) % mFrameNum;
+    mUsedSize = 0;
+
+    mStatistics.alloc_num = 0;
+    mStatistics.alloc_failed_num = 0;
+}
+
+void* UniformBlockRingBuffer::alloc(u32 size)
+{
+    RIO_ASSERT(mpBuffer != nullptr);
+    RIO_ASSERT(0 < size);
+
+    // Keep every allocation at the alignment the hardware requires for uniform block addresses / offsets
+    const u32 aligned_size = ROUNDUP(size, mAlignment);
+
+    if (mFrameSize - mUsedSize < aligned_size)
+    {
+        mStatistics.alloc_failed_num++;
+        return nullptr;
+    }
+
+    u8* ptr = mpBuffer + mFrameSize * mFrameIndex + mUsedSize;
+    mUsedSize += aligned_size;
+
+    mStatistics.alloc_num++;
+    mStatistics.peak_used_size = std::max(mStatistics.peak_used_size, mUsedSize);
+
+    return ptr;
+}
+
+void UniformBlockRingBuffer::flush(const void* p_memory, u32 size, bool invalidate_gpu) const
+{
+    RIO_ASSERT(isInBuffer_(p_memory));
+
+#if RIO_IS_CAFE
+    DCFlushRange(const_cast<void*>(p_memory), size);
+    if (invalidate_gpu)
+        GX2Invalidate(GX2_INVALIDATE_UNIFORM_BLOCK, const_cast<void*>(p_memory), size);
+#elif RIO_IS_WIN
+    RIO_GL_CALL(glBindBuffer(GL_UNIFORM_BUFFER, mHandle));
+    RIO_GL_CALL(glBufferSubData(GL_UNIFORM_BUFFER, getOffset_(p_memory), size, p_memory));
+#endif
+}
+
+bool UniformBlockRingBuffer::setUniform(const void* p_memory, u32 size, const UniformBlockLocation& location) const
+{
+    if (!location.isValid())
+        return false;
+
+    RIO_ASSERT(isInBuffer_(p_memory));
+
+#if RIO_IS_CAFE
+    if (location.getVertexLocation() != -1)
+        GX2SetVertexUniformBlock(location.getVertexLocation(), size, p_memory);
+
+    if (location.getFragmentLocation() != -1)
+        GX2SetPixelUniformBlock(location.getFragmentLocation(), size, p_memory);
+
+    if (location.getGeometryLocation() != -1)
+        GX2SetGeometryUniformBlock(location.getGeometryLocation(), size, p_memory);
+
+    return true;
+#elif RIO_IS_WIN
+    RIO_ASSERT(location.getGeometryLocation() == -1);
+
+    u32 index = location.getVertexLocation();
+    if (index == u32(-1))
+        index = location.getFragmentLocation();
+
+    if (index == u32(-1))
+        return false;
+
+    RIO_ASSERT(s32(index) == location.getFragmentLocation());
+    RIO_GL_CALL(glBindBufferRange(GL_UNIFORM_BUFFER, index, mHandle, getOffset_(p_memory), size));
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+}
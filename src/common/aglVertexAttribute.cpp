@@ -1,5 +1,6 @@
 #include <common/aglVertexAttribute.h>
 #include <common/aglVertexBuffer.h>
+#include <detail/aglBoundStateCache.h>
 
 #if RIO_IS_CAFE
 #include <coreinit/cache.h>
@@ -74,6 +75,8 @@ void VertexAttribute::destroy()
     }
 #endif
 
+    detail::BoundStateCache::invalidateVertexAttribute();
+
     mCreateFinish = false;
     mSetupFinish = false;
 }
@@ -207,6 +210,9 @@ void VertexAttribute::setUp()
 
 #endif
 
+    // Rebuilt the fetch shader / left no vertex array bound
+    detail::BoundStateCache::invalidateVertexAttribute();
+
     mSetupFinish = true;
 }
 
@@ -216,8 +222,10 @@ void VertexAttribute::activate() const
 
 #if RIO_IS_CAFE
 
-    GX2SetFetchShader(&mFetchShader);
+    if (detail::BoundStateCache::bindVertexAttribute(this))
+        GX2SetFetchShader(&mFetchShader);
 
+    // The buffers may have been reallocated without setUp() being called again, so they are always set
     for (s32 i = 0; i < mVertexBuffer.size(); i++)
     {
         const VertexBuffer* buffer = mVertexBuffer[i];
@@ -227,7 +235,8 @@ void VertexAttribute::activate() const
 
 #elif RIO_IS_WIN
 
-    RIO_GL_CALL(glBindVertexArray(mHandle));
+    if (detail::BoundStateCache::bindVertexAttribute(this))
+        RIO_GL_CALL(glBindVertexArray(mHandle));
 
 #endif
 }
@@ -0,0 +1,117 @@
+#include <detail/aglBoundStateCache.h>
+
+namespace agl { namespace detail {
+
+bool                            BoundStateCache::sEnable = false;
+const ShaderProgram*            BoundStateCache::spProgram = nullptr;
+const VertexAttribute*          BoundStateCache::spVertexAttribute = nullptr;
+BoundStateCache::TextureSlot    BoundStateCache::sTextureSlot[cTextureSlotMax] = { };
+BoundStateCache::Counter        BoundStateCache::sCounter = { };
+
+void BoundStateCache::setEnable(bool enable)
+{
+    sEnable = enable;
+    invalidate();
+}
+
+void BoundStateCache::invalidate()
+{
+    invalidateShaderProgram();
+    invalidateVertexAttribute();
+}
+
+void BoundStateCache::resetCounter()
+{
+    sCounter = Counter();
+}
+
+bool BoundStateCache::bindShaderProgram(const ShaderProgram* p_program)
+{
+    RIO_ASSERT(p_program != nullptr);
+
+    if (sEnable && spProgram == p_program)
+    {
+        sCounter.program_elided++;
+        return false;
+    }
+
+    if (sEnable)
+        spProgram = p_program;
+
+    sCounter.program_bind++;
+    return true;
+}
+
+bool BoundStateCache::bindVertexAttribute(const VertexAttribute* p_attribute)
+{
+    RIO_ASSERT(p_attribute != nullptr);
+
+    if (sEnable && spVertexAttribute == p_attribute)
+    {
+        sCounter.vertex_attribute_elided++;
+        return false;
+    }
+
+    if (sEnable)
+        spVertexAttribute = p_attribute;
+
+    sCounter.vertex_attribute_bind++;
+    return true;
+}
+
+bool BoundStateCache::bindTextureSampler(const TextureSampler* p_sampler, s32 vs, s32 fs, s32 gs, s32 slot)
+{
+    RIO_ASSERT(p_sampler != nullptr);
+
+    if (!sEnable || slot < 0 || slot >= cTextureSlotMax)
+    {
+        sCounter.sampler_bind++;
+        return true;
+    }
+
+    TextureSlot& entry = sTextureSlot[slot];
+
+    // The sampler uniforms belong to the program on Windows, so the program is part of the key
+    if (entry.p_sampler == p_sampler && entry.p_program == spProgram && spProgram != nullptr &&
+        entry.vs == vs && entry.fs == fs && entry.gs == gs)
+    {
+        sCounter.sampler_elided++;
+        return false;
+    }
+
+    // On Cafe, the locations are the hardware units, which other slots may have used
+    for (s32 i = 0; i < cTextureSlotMax; i++)
+    {
+        TextureSlot& other = sTextureSlot[i];
+        if ((vs != -1 && other.vs == vs) || (fs != -1 && other.fs == fs) || (gs != -1 && other.gs == gs))
+            other = TextureSlot();
+    }
+
+    entry.p_sampler = p_sampler;
+    entry.p_program = spProgram;
+    entry.vs = vs;
+    entry.fs = fs;
+    entry.gs = gs;
+
+    sCounter.sampler_bind++;
+    return true;
+}
+
+void BoundStateCache::invalidateShaderProgram()
+{
+    spProgram = nullptr;
+    invalidateTextureSampler();
+}
+
+void BoundStateCache::invalidateVertexAttribute()
+{
+    spVertexAttribute = nullptr;
+}
+
+void BoundStateCache::invalidateTextureSampler()
+{
+    for (s32 i = 0; i < cTextureSlotMax; i++)
+        sTextureSlot[i] = TextureSlot();
+}
+
+} }
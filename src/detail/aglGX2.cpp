@@ -1,3 +1,4 @@
+#include <detail/aglBoundStateCache.h>
 #include <detail/aglGX2.h>
 #include <misc/rio_MemUtil.h>
 
@@ -177,6 +178,9 @@ void GX2Resource::restoreContextState()
     {
         GX2SetContextState(nullptr);
     }
+
+    // The context state replaces whatever agl had bound
+    detail::BoundStateCache::invalidate();
 }
 
 #endif // RIO_IS_CAFE
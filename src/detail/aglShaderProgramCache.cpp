@@ -0,0 +1,122 @@
+#include <codec/HashCRC32.h>
+#include <detail/aglShaderProgramCache.h>
+#include <misc/MD5.h>
+
+#include <filesystem>
+#include <fstream>
+
+namespace agl { namespace detail {
+
+std::string ShaderProgramCache::sDirectory = "";
+
+std::string ShaderProgramCache::calcKey(ShaderCompileInfo::Target target, const std::string& vertex_src, const std::string& fragment_src)
+{
+    const u8 target_u8 = target;
+
+    MD5 md5;
+    md5.update(&target_u8, 1);
+    md5.update(vertex_src.c_str(), vertex_src.length() + 1);
+    md5.update(fragment_src.c_str(), fragment_src.length() + 1);
+    md5.finalize();
+
+    return md5.hexdigest();
+}
+
+std::string ShaderProgramCache::getPath_(const std::string& key)
+{
+    return sDirectory + '/' + key + ".bin";
+}
+
+bool ShaderProgramCache::read(const std::string& key, u32* p_format, std::string* p_binary)
+{
+    RIO_ASSERT(p_format != nullptr);
+    RIO_ASSERT(p_binary != nullptr);
+
+    if (!isEnabled())
+        return false;
+
+    std::ifstream inf(getPath_(key), std::ifstream::in | std::ifstream::binary);
+    if (!inf)
+        return false;
+
+    Header header;
+    if (!inf.read(reinterpret_cast<char*>(&header), sizeof(Header)))
+        return false;
+
+    if (header.mMagic != cMagic || header.mVersion != cVersion || header.mSize == 0)
+    {
+        RIO_LOG("agl::detail::ShaderProgramCache: Ignoring stale entry %s\n", key.c_str());
+        return false;
+    }
+
+    p_binary->resize(header.mSize);
+    if (!inf.read(p_binary->data(), header.mSize) || inf.peek() != std::ifstream::traits_type::eof())
+    {
+        RIO_LOG("agl::detail::ShaderProgramCache: Ignoring truncated entry %s\n", key.c_str());
+        return false;
+    }
+
+    if (HashCRC32::calcHash(p_binary->data(), header.mSize) != header.mHash)
+    {
+        RIO_LOG("agl::detail::ShaderProgramCache: Ignoring corrupted entry %s\n", key.c_str());
+        return false;
+    }
+
+    *p_format = header.mFormat;
+    return true;
+}
+
+bool ShaderProgramCache::write(const std::string& key, u32 format, const std::string& binary)
+{
+    if (!isEnabled() || binary.empty())
+        return false;
+
+    const std::string& path = getPath_(key);
+    const std::string& temp_path = path + ".tmp";
+
+    Header header;
+    header.mMagic = cMagic;
+    header.mVersion = cVersion;
+    header.mFormat = format;
+    header.mSize = binary.size();
+    header.mHash = HashCRC32::calcHash(binary.data(), binary.size());
+
+    {
+        std::ofstream outf(temp_path, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+        if (!outf)
+            return false;
+
+        outf.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        outf.write(binary.data(), binary.size());
+
+        if (!outf.flush())
+        {
+            outf.close();
+            std::error_code ec;
+            std::filesystem::remove(temp_path, ec);
+            return false;
+        }
+    }
+
+    // Readers only ever see complete entries
+    std::error_code ec;
+    std::filesystem::rename(temp_path, path, ec);
+    if (ec)
+    {
+        std::filesystem::remove(temp_path, ec);
+        return false;
+    }
+
+    return true;
+}
+
+void ShaderProgramCache::remove(const std::string& key)
+{
+    if (!isEnabled())
+        return;
+
+    std::error_code ec;
+    std::filesystem::remove(getPath_(key), ec);
+}
+
+} }
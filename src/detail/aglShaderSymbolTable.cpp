@@ -0,0 +1,125 @@
+#include <codec/HashCRC32.h>
+#include <detail/aglShaderSymbolTable.h>
+
+#include <algorithm>
+#include <cstring>
+
+#if RIO_IS_CAFE || RIO_IS_WIN
+
+namespace agl { namespace detail {
+
+ShaderSymbolTable::ShaderSymbolTable()
+    : mpShader(nullptr)
+{
+}
+
+void ShaderSymbolTable::build(const GX2VertexShader* p_shader)
+{
+    RIO_ASSERT(p_shader != nullptr);
+
+    clear();
+
+#ifdef __WUT__
+    build_(cKind_UniformVar,   p_shader->uniformVars,   p_shader->uniformVarCount);
+    build_(cKind_UniformBlock, p_shader->uniformBlocks, p_shader->uniformBlockCount);
+    build_(cKind_SamplerVar,   p_shader->samplerVars,   p_shader->samplerVarCount);
+    build_(cKind_AttribVar,    p_shader->attribVars,    p_shader->attribVarCount);
+#else
+    build_(cKind_UniformVar,   p_shader->uniformVars,   p_shader->numUniforms);
+    build_(cKind_UniformBlock, p_shader->uniformBlocks, p_shader->numUniformBlocks);
+    build_(cKind_SamplerVar,   p_shader->samplerVars,   p_shader->numSamplers);
+    build_(cKind_AttribVar,    p_shader->attribVars,    p_shader->numAttribs);
+#endif // __WUT__
+
+    mpShader = p_shader;
+}
+
+void ShaderSymbolTable::build(const GX2PixelShader* p_shader)
+{
+    RIO_ASSERT(p_shader != nullptr);
+
+    clear();
+
+#ifdef __WUT__
+    build_(cKind_UniformVar,   p_shader->uniformVars,   p_shader->uniformVarCount);
+    build_(cKind_UniformBlock, p_shader->uniformBlocks, p_shader->uniformBlockCount);
+    build_(cKind_SamplerVar,   p_shader->samplerVars,   p_shader->samplerVarCount);
+#else
+    build_(cKind_UniformVar,   p_shader->uniformVars,   p_shader->numUniforms);
+    build_(cKind_UniformBlock, p_shader->uniformBlocks, p_shader->numUniformBlocks);
+    build_(cKind_SamplerVar,   p_shader->samplerVars,   p_shader->numSamplers);
+#endif // __WUT__
+
+    mpShader = p_shader;
+}
+
+void ShaderSymbolTable::build(const GX2GeometryShader* p_shader)
+{
+    RIO_ASSERT(p_shader != nullptr);
+
+    clear();
+
+#ifdef __WUT__
+    build_(cKind_UniformVar,   p_shader->uniformVars,   p_shader->uniformVarCount);
+    build_(cKind_UniformBlock, p_shader->uniformBlocks, p_shader->uniformBlockCount);
+    build_(cKind_SamplerVar,   p_shader->samplerVars,   p_shader->samplerVarCount);
+#else
+    build_(cKind_UniformVar,   p_shader->uniformVars,   p_shader->numUniforms);
+    build_(cKind_UniformBlock, p_shader->uniformBlocks, p_shader->numUniformBlocks);
+    build_(cKind_SamplerVar,   p_shader->samplerVars,   p_shader->numSamplers);
+#endif // __WUT__
+
+    mpShader = p_shader;
+}
+
+void ShaderSymbolTable::clear()
+{
+    for (s32 kind = 0; kind < cKind_Num; kind++)
+        mEntry[kind].clear();
+
+    mpShader = nullptr;
+}
+
+template <typename T>
+void ShaderSymbolTable::build_(Kind kind, const T* vars, u32 num)
+{
+    std::vector<Entry>& entry = mEntry[kind];
+    entry.reserve(num);
+
+    for (u32 i = 0; i < num; i++)
+        entry.push_back({ calcHash_(vars[i].name), i, vars[i].name });
+
+    // Stable, so that the first of several variables sharing a name is found, as with a linear search
+    std::stable_sort(
+        entry.begin(), entry.end(),
+        [](const Entry& lhs, const Entry& rhs) { return lhs.hash < rhs.hash; }
+    );
+}
+
+s32 ShaderSymbolTable::search(Kind kind, const char* name) const
+{
+    RIO_ASSERT(name != nullptr);
+
+    const std::vector<Entry>& entry = mEntry[kind];
+    const u32 hash = calcHash_(name);
+
+    std::vector<Entry>::const_iterator itr = std::lower_bound(
+        entry.begin(), entry.end(), hash,
+        [](const Entry& lhs, u32 rhs) { return lhs.hash < rhs; }
+    );
+
+    for (; itr != entry.end() && itr->hash == hash; ++itr)
+        if (std::strcmp(itr->name, name) == 0)
+            return itr->index;
+
+    return -1;
+}
+
+u32 ShaderSymbolTable::calcHash_(const char* name)
+{
+    return HashCRC32::calcHash(name, std::strlen(name));
+}
+
+} }
+
+#endif // RIO_IS_CAFE || RIO_IS_WIN
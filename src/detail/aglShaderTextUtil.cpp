@@ -1,103 +1,185 @@
 #include <detail/aglShaderTextUtil.h>
 #include <misc/rio_MemUtil.h>
 
-#include <map>
+#include <string_view>
 #include <unordered_map>
 
-namespace agl { namespace detail {
+namespace {
 
-void ShaderTextUtil::replaceMacro(std::string* p_text, const std::unordered_map<std::string, const std::string>& macro_map_)
+enum MacroSet
 {
-    RIO_ASSERT(p_text != nullptr);
-  //RIO_ASSERT(p_text->length() == std::strlen(p_text->c_str()));
+    cMacroSet_Macro,
+    cMacroSet_Variation,
+    cMacroSet_Num
+};
 
-    std::string::size_type text_pos = 0;
+struct MacroEntry
+{
+    const std::string* value[cMacroSet_Num] = { nullptr, nullptr };
+    bool is_used[cMacroSet_Num] = { false, false };     // A macro only replaces its first definition
+};
 
-    std::map<std::string, const std::string> macro_map(macro_map_.begin(), macro_map_.end());
+typedef std::unordered_map<std::string_view, MacroEntry> MacroTable;
 
-    while (text_pos < p_text->length())
+// Whether s[begin, end) contains a '#' that a directive scan would take for the start of "#define"
+bool HasDefineDirective(const std::string& s, std::string::size_type begin, std::string::size_type end)
+{
+    for (std::string::size_type pos = s.find('#', begin); pos < end; pos = s.find('#', pos + 1))
     {
-        const std::string::size_type include_directive_begin = p_text->find_first_of('#', text_pos);
-        if (include_directive_begin == std::string::npos)
+        const std::string::size_type directive_pos = s.find_first_not_of(" \t", pos + 1, 2);
+        if (directive_pos != std::string::npos && s.compare(directive_pos, 6, "define", 6) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+// Scans text once, writing it to p_out with the value of every matched "#define NAME ..." line replaced.
+// Macro names must not contain whitespace. If both sets are used and a line would be scanned differently
+// than when applying them one after the other, returns false and p_out must be discarded.
+bool ReplaceMacroImpl(const std::string& text, std::string* p_out, MacroTable& table, bool use_macro, bool use_variation)
+{
+    const std::string::size_type text_len = text.length();
+    std::string::size_type text_pos = 0;
+    std::string::size_type copy_pos = 0;
+
+    while (text_pos < text_len)
+    {
+        const std::string::size_type define_directive_begin = text.find('#', text_pos);
+        if (define_directive_begin == std::string::npos)
             break;
 
-        text_pos = p_text->find_first_not_of(" \t", include_directive_begin + 1, 2);
+        text_pos = text.find_first_not_of(" \t", define_directive_begin + 1, 2);
         if (text_pos == std::string::npos)
             break;
 
-        if (p_text->compare(text_pos, 6, "define", 6) != 0)
+        if (text.compare(text_pos, 6, "define", 6) != 0)
             continue;
 
-        if (text_pos + 6 >= p_text->length() ||
-            (p_text->at(text_pos + 6) != ' ' &&
-             p_text->at(text_pos + 6) != '\t'))
+        if (text_pos + 6 >= text_len ||
+            (text[text_pos + 6] != ' ' &&
+             text[text_pos + 6] != '\t'))
         {
-          //RIO_ASSERT(false);
             break;
         }
 
-        text_pos = p_text->find_first_not_of(" \t", text_pos + 7, 2);
+        text_pos = text.find_first_not_of(" \t", text_pos + 7, 2);
         if (text_pos == std::string::npos)
-        {
-          //RIO_ASSERT(false);
             break;
-        }
 
-        std::string::size_type line_feed_pos = p_text->find_first_of("\r\n", text_pos, 2);
+        std::string::size_type line_feed_pos = text.find_first_of("\r\n", text_pos, 2);
         if (line_feed_pos == std::string::npos)
-            line_feed_pos = p_text->length();
+            line_feed_pos = text_len;
+
+        // The name must be followed by a space or tab on the same line
+        std::string::size_type name_end = text_pos;
+        while (name_end < line_feed_pos && text[name_end] != ' ' && text[name_end] != '\t')
+            name_end++;
 
-        auto itr_match_macro = macro_map.lower_bound(p_text->substr(text_pos, line_feed_pos - text_pos));
-        if (itr_match_macro == macro_map.begin())
+        if (name_end == line_feed_pos)
             continue;
 
-        --itr_match_macro;
+        const std::string_view name(text.data() + text_pos, name_end - text_pos);
 
-        bool found = false;
+        const auto& itr_entry = table.find(name);
+        if (itr_entry == table.end())
+            continue;
 
-        while (true)
-        {
-            if (p_text->compare(text_pos, itr_match_macro->first.length(), itr_match_macro->first) != 0)
-                break;
+        MacroEntry& entry = itr_entry->second;
+        const bool match_macro = use_macro && entry.value[cMacroSet_Macro] && !entry.is_used[cMacroSet_Macro];
+        const bool match_variation = use_variation && entry.value[cMacroSet_Variation] && !entry.is_used[cMacroSet_Variation];
 
-            if (text_pos + itr_match_macro->first.length() >= p_text->length() ||
-                (p_text->at(text_pos + itr_match_macro->first.length()) != ' ' &&
-                 p_text->at(text_pos + itr_match_macro->first.length()) != '\t'))
-            {
-                if (itr_match_macro == macro_map.begin())
-                    break;
+        if (!match_macro && !match_variation)
+            continue;
 
-                --itr_match_macro;
-                continue;
-            }
+        // Applied one after the other, the rest of a line replaced by only one of the sets is still scanned by the other one
+        if (match_macro != match_variation && use_macro && use_variation)
+        {
+            if (name.find('#') != std::string_view::npos)
+                return false;
 
-            found = true;
-            break;
+            if (match_macro ? HasDefineDirective(*entry.value[cMacroSet_Macro], 0, entry.value[cMacroSet_Macro]->length())
+                            : HasDefineDirective(text, name_end, line_feed_pos))
+                return false;
         }
 
-        if (!found)
-            continue;
+        const std::string& value = match_variation ? *entry.value[cMacroSet_Variation] : *entry.value[cMacroSet_Macro];
 
-        const std::string& match_macro = itr_match_macro->first;
-      //RIO_ASSERT(match_macro.length() == std::strlen(match_macro.c_str()));
+        entry.is_used[cMacroSet_Macro] |= match_macro;
+        entry.is_used[cMacroSet_Variation] |= match_variation;
 
-        const std::string& macro_value = itr_match_macro->second;
-      //RIO_ASSERT(macro_value.length() == std::strlen(macro_value.c_str()));
+        p_out->append(text, copy_pos, define_directive_begin - copy_pos);
+        p_out->append("#define ", 8);
+        p_out->append(name);
+        p_out->push_back(' ');
+        p_out->append(value);
 
-        const std::string::size_type define_len = 9 + match_macro.length() + macro_value.length(); // 9 == strlen("#define") + strlen(" ") + strlen(" ")
-        char* const define_buf = new char[define_len + 1];
-        std::snprintf(define_buf, define_len + 1, "#define %s %s", match_macro.c_str(), itr_match_macro->second.c_str());
-      //RIO_ASSERT(define_len == std::strlen(define_buf));
+        text_pos = line_feed_pos;
+        copy_pos = line_feed_pos;
+    }
 
-        p_text->replace(include_directive_begin, line_feed_pos - include_directive_begin, define_buf, define_len);
+    p_out->append(text, copy_pos, std::string::npos);
+    return true;
+}
+
+}
+
+namespace agl { namespace detail {
+
+void ShaderTextUtil::replaceMacro(std::string* p_text, const std::unordered_map<std::string, const std::string>& macro_map)
+{
+    static const std::unordered_map<std::string, const std::string> sEmptyMap;
+    replaceMacro(p_text, macro_map, sEmptyMap);
+}
+
+void ShaderTextUtil::replaceMacro(std::string* p_text, const std::unordered_map<std::string, const std::string>& macro_map, const std::unordered_map<std::string, const std::string>& variation_map)
+{
+    RIO_ASSERT(p_text != nullptr);
+  //RIO_ASSERT(p_text->length() == std::strlen(p_text->c_str()));
+
+    if (macro_map.empty() && variation_map.empty())
+        return;
 
-        delete[] define_buf;
+    MacroTable table;
+    table.reserve(macro_map.size() + variation_map.size());
 
-        text_pos = include_directive_begin + define_len;
+    std::string::size_type reserve_len = p_text->length();
 
-        macro_map.erase(itr_match_macro);
+    for (const auto& itr_macro : macro_map)
+    {
+        table[itr_macro.first].value[cMacroSet_Macro] = &itr_macro.second;
+        reserve_len += 9 + itr_macro.first.length() + itr_macro.second.length();
+    }
+
+    for (const auto& itr_variation : variation_map)
+    {
+        table[itr_variation.first].value[cMacroSet_Variation] = &itr_variation.second;
+        reserve_len += 9 + itr_variation.first.length() + itr_variation.second.length();
     }
 
+    std::string buffer;
+    buffer.reserve(reserve_len);
+
+    if (macro_map.empty() || variation_map.empty())
+    {
+        ReplaceMacroImpl(*p_text, &buffer, table, !macro_map.empty(), !variation_map.empty());
+    }
+    else if (!ReplaceMacroImpl(*p_text, &buffer, table, true, true))
+    {
+        // A directive depends on the order in which the sets are applied, so apply them one after the other
+        for (auto& itr_entry : table)
+            itr_entry.second.is_used[cMacroSet_Macro] = itr_entry.second.is_used[cMacroSet_Variation] = false;
+
+        std::string temp;
+        temp.reserve(reserve_len);
+        buffer.clear();
+
+        ReplaceMacroImpl(*p_text, &temp, table, true, false);
+        ReplaceMacroImpl(temp, &buffer, table, false, true);
+    }
+
+    p_text->swap(buffer);
+
   //RIO_ASSERT(p_text->length() == std::strlen(p_text->c_str()));
 }
 
@@ -1168,7 +1168,7 @@ DepthOfField::DrawArg::DrawArg(Context& ctx, const RenderBuffer& render_buffer,
     p_ctx->mDepthTargetTextureSampler.applyTextureData(depth);
 }
 
-DepthOfField::TempVignetting::TempVignetting(DepthOfField* p_dof, const char* param_name)
+DepthOfField::TempVignetting::TempVignetting(DepthOfField* p_dof, const utl::ParameterName& param_name)
     : utl::IParameterObj()
     , mType (0,                             "type",  "形状",    this)
     , mRange(rio::Vector2f{0.25f, 1.0f},    "range", "変化幅",  this)
@@ -96,12 +96,31 @@ bool ParameterBase::copy(const ParameterBase& parameter)
 
 void ParameterBase::copyUnsafe(const ParameterBase& parameter)
 {
-    u8* dst = static_cast<u8*>(ptr());
-    const u8* src = static_cast<const u8*>(parameter.ptr());
-    s32 len = size();
+    void* dst = ptr();
+    const void* src = parameter.ptr();
 
-    for (s32 i = 0; i < len; i++)
-        *dst++ = *src++;
+    // Fixed sizes let the compiler turn the copy into a few register moves
+    switch (size())
+    {
+    case 1:
+        std::memcpy(dst, src, 1);
+        break;
+    case 4:
+        std::memcpy(dst, src, 4);
+        break;
+    case 8:
+        std::memcpy(dst, src, 8);
+        break;
+    case 12:
+        std::memcpy(dst, src, 12);
+        break;
+    case 16:
+        std::memcpy(dst, src, 16);
+        break;
+    default:
+        std::memcpy(dst, src, size());
+        break;
+    }
 }
 
 bool ParameterBase::copyLerp(const ParameterBase& parameter_a, const ParameterBase& parameter_b, f32 t)
@@ -149,9 +168,9 @@ bool ParameterBase::copyLerp(const ParameterBase& parameter_a, const ParameterBa
     return true;
 }
 
-void ParameterBase::initializeListNode(const char* name, const char* label, const char* meta, IParameterObj* p_obj)
+void ParameterBase::initializeListNode(const ParameterName& name, const char* label, const char* meta, IParameterObj* p_obj)
 {
-    mHash = calcHash(name);
+    mHash = name.getHash();
 
     if (p_obj)
         p_obj->pushBackListNode(this);
@@ -162,4 +181,9 @@ u32 ParameterBase::calcHash(const char* s)
     return HashCRC32::calcHash(s, std::strlen(s));
 }
 
+u32 ParameterName::calcHash_(const char* name)
+{
+    return ParameterBase::calcHash(name);
+}
+
 } }
@@ -0,0 +1,157 @@
+#include <misc/rio_MemUtil.h>
+#include <utility/aglParameter.h>
+#include <utility/aglParameterApplyPlan.h>
+#include <utility/aglParameterList.h>
+#include <utility/aglParameterObj.h>
+
+namespace agl { namespace utl {
+
+
+ParameterApplyPlan::ParameterApplyPlan()
+    : mpRoot(nullptr)
+    , mpArchive(nullptr)
+    , mArchiveSize(0)
+    , mTreeRevision(0)
+{
+}
+
+void ParameterApplyPlan::build(IParameterList* p_root, ResParameterArchive arc)
+{
+    RIO_ASSERT(p_root != nullptr);
+    RIO_ASSERT(arc.isValid());
+
+    mOp.clear();
+    buildList_(p_root, arc.getResParameterList());
+
+    mpRoot = p_root;
+    mpArchive = arc.ptr();
+    mArchiveSize = arc.ref().mFileSize;
+    mTreeRevision = p_root->getTreeRevision();
+}
+
+void ParameterApplyPlan::clear()
+{
+    mOp.clear();
+    mpRoot = nullptr;
+    mpArchive = nullptr;
+    mArchiveSize = 0;
+}
+
+bool ParameterApplyPlan::isValid(const IParameterList* p_root, ResParameterArchive arc) const
+{
+    return mpRoot != nullptr &&
+           mpRoot == p_root &&
+           mpArchive == arc.ptr() &&
+           mArchiveSize == arc.ref().mFileSize &&
+           mTreeRevision == p_root->getTreeRevision();
+}
+
+void ParameterApplyPlan::buildList_(IParameterList* p_list, ResParameterList res)
+{
+    // Same matching as IParameterList::applyResParameterList_()
+    const u32 begin = mOp.size();
+    mOp.push_back({ cOp_BeginList, 0, p_list, nullptr, nullptr });
+
+    for (u32 i = 0; i < res.getResParameterObjNum(); i++)
+    {
+        ResParameterObj child_obj = res.getResParameterObj(i);
+
+        IParameterObj* p_obj = p_list->findObj_(child_obj);
+        if (p_obj != nullptr)
+            buildObj_(p_obj, child_obj, p_list);
+    }
+
+    for (u32 i = 0; i < res.getResParameterListNum(); i++)
+    {
+        ResParameterList child_list = res.getResParameterList(i);
+
+        IParameterList* p_child = p_list->findList_(child_list);
+        if (p_child != nullptr)
+            buildList_(p_child, child_list);
+    }
+
+    mOp.push_back({ cOp_EndList, 0, p_list, nullptr, nullptr });
+    mOp[begin].value = mOp.size();
+}
+
+void ParameterApplyPlan::buildObj_(IParameterObj* p_obj, ResParameterObj res, IParameterList* p_list)
+{
+    // Same matching as IParameterObj::applyResParameterObj_()
+    const u32 begin = mOp.size();
+    mOp.push_back({ cOp_BeginObj, 0, p_obj, nullptr, nullptr });
+
+    for (ResParameterObj::constIterator itr_res = res.constBegin(), itr_res_end = res.constEnd(); itr_res != itr_res_end; ++itr_res)
+    {
+        const ResParameterData* p_res = &(*itr_res);
+
+        ParameterBase* p_param = p_obj->findParameter_(p_res->mNameHash);
+        if (p_param != nullptr)
+        {
+            const OpType type = p_param->getParameterType() == ParameterBase::cType_bool ? cOp_CopyBool : cOp_Copy;
+            mOp.push_back({ type, u32(p_param->size()), p_param, p_param->ptr(), p_res });
+        }
+        else
+        {
+            mOp.push_back({ cOp_NotAppliable, 0, p_obj, p_list, p_res });
+        }
+    }
+
+    mOp.push_back({ cOp_EndObj, 0, p_obj, nullptr, nullptr });
+    mOp[begin].value = mOp.size();
+}
+
+void ParameterApplyPlan::apply() const
+{
+    const Op* const ops = mOp.data();
+    const u32 op_num = mOp.size();
+
+    for (u32 i = 0; i < op_num; )
+    {
+        const Op& op = ops[i];
+
+        switch (op.type)
+        {
+        case cOp_BeginList:
+            if (!static_cast<IParameterList*>(op.p_node)->preRead_())
+            {
+                i = op.value;
+                continue;
+            }
+            break;
+        case cOp_EndList:
+            static_cast<IParameterList*>(op.p_node)->postRead_();
+            break;
+        case cOp_BeginObj:
+            if (!static_cast<IParameterObj*>(op.p_node)->preRead_())
+            {
+                i = op.value;
+                continue;
+            }
+            break;
+        case cOp_EndObj:
+            static_cast<IParameterObj*>(op.p_node)->postRead_();
+            break;
+        case cOp_Copy:
+        case cOp_CopyBool:
+            {
+                // Same as ParameterBase::applyResource(ResParameter)
+                const void* src = op.p_res + 1;
+
+                if (op.type == cOp_Copy)
+                    rio::MemUtil::copy(op.p_dst, src, op.value);
+                else
+                    *static_cast<bool*>(op.p_dst) = *static_cast<const u8*>(src) != 0;
+
+                static_cast<ParameterBase*>(op.p_node)->postApplyResource_(src, op.p_res->mSize - sizeof(ResParameterData));
+            }
+            break;
+        case cOp_NotAppliable:
+            static_cast<IParameterObj*>(op.p_node)->notifyNotAppliable_(ResParameter(op.p_res), static_cast<IParameterList*>(op.p_dst));
+            break;
+        }
+
+        i++;
+    }
+}
+
+} }
@@ -0,0 +1,288 @@
+#include <utility/aglParameter.h>
+#include <utility/aglParameterArchiveWriter.h>
+#include <utility/aglParameterList.h>
+#include <utility/aglParameterObj.h>
+#include <utility/aglResParameter.h>
+
+#include <cstring>
+
+namespace {
+
+inline u32 AlignUp(u32 value, u32 alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+inline void WriteU32(u8* dst, u32 value, bool is_le)
+{
+    if (is_le)
+    {
+        dst[0] = value;
+        dst[1] = value >> 8;
+        dst[2] = value >> 16;
+        dst[3] = value >> 24;
+    }
+    else
+    {
+        dst[0] = value >> 24;
+        dst[1] = value >> 16;
+        dst[2] = value >> 8;
+        dst[3] = value;
+    }
+}
+
+inline u32 CalcTypeLength(const char* type)
+{
+    return AlignUp(std::strlen(type) + 1, 4);
+}
+
+}
+
+namespace agl { namespace utl {
+
+ParameterArchiveWriter::ParameterArchiveWriter(const IParameterList* p_root, const char* type, u32 type_version)
+    : mpRoot(p_root)
+    , mType(type)
+    , mTypeVersion(type_version)
+    , mArchiveSize(0)
+    , mIncludeIndex(0)
+    , mIsPostWritten(false)
+{
+    RIO_ASSERT(p_root != nullptr);
+    RIO_ASSERT(type != nullptr);
+
+    // The root list is always written, but without children if it is excluded
+    const bool include = p_root->preWrite_();
+    mInclude.push_back(include);
+
+    mArchiveSize = sizeof(ResParameterArchiveData) + CalcTypeLength(type);
+
+    if (include)
+    {
+        mArchiveSize += prepareList_(p_root);
+        mIncludedNode.push_back({ p_root, nullptr });
+    }
+    else
+    {
+        mArchiveSize += sizeof(ResParameterListData);
+    }
+}
+
+ParameterArchiveWriter::~ParameterArchiveWriter()
+{
+    callPostWrite_();
+}
+
+u32 ParameterArchiveWriter::write(void* dst, u32 dst_size, bool is_le)
+{
+    RIO_ASSERT(dst != nullptr);
+    RIO_ASSERT(uintptr_t(dst) % 4 == 0);
+
+    const u32 file_size = mArchiveSize;
+    if (dst_size < file_size)
+    {
+        RIO_LOG("ParameterArchiveWriter::write(): dst_size[%u] is smaller than archive size[%u].\n", dst_size, file_size);
+        return 0;
+    }
+
+    u8* p = static_cast<u8*>(dst);
+
+    // Header, read back as host-order u32 values once ResParameterArchive has resolved the endianness
+    const u32 type_len = CalcTypeLength(mType.c_str());
+
+    WriteU32(p + 0x00, ResParameterArchiveData::getSignature(), is_le);
+    WriteU32(p + 0x04, ResParameterArchiveData::getVersion(), is_le);
+    WriteU32(p + 0x08, is_le ? 1 : 0, is_le); // Little endian flag
+    WriteU32(p + 0x0C, file_size, is_le);
+    WriteU32(p + 0x10, mTypeVersion, is_le);
+    WriteU32(p + 0x14, type_len, is_le);
+    p += sizeof(ResParameterArchiveData);
+
+    std::memset(p, 0, type_len);
+    std::memcpy(p, mType.c_str(), mType.length());
+    p += type_len;
+
+    mIncludeIndex = 0;
+    p = writeList_(p, mpRoot, mInclude[mIncludeIndex++], is_le);
+
+    RIO_ASSERT(mIncludeIndex == mInclude.size());
+    RIO_ASSERT(p == static_cast<u8*>(dst) + file_size);
+
+    callPostWrite_();
+    return file_size;
+}
+
+u32 ParameterArchiveWriter::prepareList_(const IParameterList* p_list)
+{
+    // Same order as writeList_()
+    u32 size = sizeof(ResParameterListData);
+
+    for (OffsetList<IParameterList>::iterator itr = p_list->mChildList.begin(), itr_end = p_list->mChildList.end(); itr != itr_end; ++itr)
+    {
+        const IParameterList* p_child = &(*itr);
+        const bool include = p_child->preWrite_();
+        mInclude.push_back(include);
+
+        if (include)
+        {
+            size += prepareList_(p_child);
+            mIncludedNode.push_back({ p_child, nullptr });
+        }
+    }
+
+    for (OffsetList<IParameterObj>::iterator itr = p_list->mChildObj.begin(), itr_end = p_list->mChildObj.end(); itr != itr_end; ++itr)
+    {
+        const IParameterObj* p_child = &(*itr);
+        const bool include = p_child->preWrite_();
+        mInclude.push_back(include);
+
+        if (include)
+        {
+            size += prepareObj_(p_child);
+            mIncludedNode.push_back({ nullptr, p_child });
+        }
+    }
+
+    return size;
+}
+
+u32 ParameterArchiveWriter::prepareObj_(const IParameterObj* p_obj)
+{
+    u32 size = sizeof(ResParameterObjData);
+
+    for (OffsetList<ParameterBase>::iterator itr = p_obj->mChildParameter.begin(), itr_end = p_obj->mChildParameter.end(); itr != itr_end; ++itr)
+        size += calcParameterSize_(&(*itr));
+
+    return size;
+}
+
+u32 ParameterArchiveWriter::calcParameterSize_(const ParameterBase* p_param)
+{
+    return sizeof(ResParameterData) + AlignUp(p_param->size(), 4);
+}
+
+u8* ParameterArchiveWriter::writeList_(u8* dst, const IParameterList* p_list, bool include, bool is_le)
+{
+    // Child lists come first, then child objects, as ResParameterList expects
+    u8* p = dst + sizeof(ResParameterListData);
+    u32 list_num = 0;
+    u32 obj_num = 0;
+
+    if (include)
+    {
+        for (OffsetList<IParameterList>::iterator itr = p_list->mChildList.begin(), itr_end = p_list->mChildList.end(); itr != itr_end; ++itr)
+        {
+            if (!mInclude[mIncludeIndex++])
+                continue;
+
+            p = writeList_(p, &(*itr), true, is_le);
+            list_num++;
+        }
+
+        for (OffsetList<IParameterObj>::iterator itr = p_list->mChildObj.begin(), itr_end = p_list->mChildObj.end(); itr != itr_end; ++itr)
+        {
+            if (!mInclude[mIncludeIndex++])
+                continue;
+
+            p = writeObj_(p, &(*itr), is_le);
+            obj_num++;
+        }
+    }
+
+    WriteU32(dst + 0x0, p - dst, is_le);
+    WriteU32(dst + 0x4, p_list->mNameHash, is_le);
+    WriteU32(dst + 0x8, list_num, is_le);
+    WriteU32(dst + 0xC, obj_num, is_le);
+
+    return p;
+}
+
+u8* ParameterArchiveWriter::writeObj_(u8* dst, const IParameterObj* p_obj, bool is_le)
+{
+    u8* p = dst + sizeof(ResParameterObjData);
+    u32 num = 0;
+
+    for (OffsetList<ParameterBase>::iterator itr = p_obj->mChildParameter.begin(), itr_end = p_obj->mChildParameter.end(); itr != itr_end; ++itr)
+    {
+        p = writeParameter_(p, &(*itr), is_le);
+        num++;
+    }
+
+    WriteU32(dst + 0x0, p - dst, is_le);
+    WriteU32(dst + 0x4, num, is_le);
+    WriteU32(dst + 0x8, p_obj->mNameHash, is_le);
+    WriteU32(dst + 0xC, 0, is_le);
+
+    return p;
+}
+
+u8* ParameterArchiveWriter::writeParameter_(u8* dst, const ParameterBase* p_param, bool is_le)
+{
+    const ParameterBase::ParameterType type = p_param->getParameterType();
+    const u32 size = p_param->size();
+    const u32 value_size = AlignUp(size, 4);
+
+    WriteU32(dst + 0x0, sizeof(ResParameterData) + value_size, is_le);
+    WriteU32(dst + 0x4, type, is_le);
+    WriteU32(dst + 0x8, p_param->getNameHash(), is_le);
+
+    u8* const value = dst + sizeof(ResParameterData);
+    const u8* const src = static_cast<const u8*>(p_param->ptr());
+
+    // Same byte order rules as ResParameterObj::modifyEndianObj()
+    switch (type)
+    {
+    case ParameterBase::cType_bool:
+        std::memset(value, 0, value_size);
+        value[0] = *reinterpret_cast<const bool*>(src) ? 1 : 0;
+        break;
+    case ParameterBase::cType_string32:
+    case ParameterBase::cType_string64:
+        std::memset(value, 0, value_size);
+        std::memcpy(value, src, size);
+        break;
+    case ParameterBase::cType_f32:
+    case ParameterBase::cType_int:
+    case ParameterBase::cType_vec2:
+    case ParameterBase::cType_vec3:
+    case ParameterBase::cType_vec4:
+    case ParameterBase::cType_color:
+    case ParameterBase::cType_curve1:
+    case ParameterBase::cType_curve2:
+    case ParameterBase::cType_curve3:
+    case ParameterBase::cType_curve4:
+        RIO_ASSERT(size % 4 == 0);
+        for (u32 i = 0; i < size; i += 4)
+        {
+            u32 word;
+            std::memcpy(&word, src + i, sizeof(u32));
+            WriteU32(value + i, word, is_le);
+        }
+        break;
+    default:
+        RIO_LOG("illigal type:%d\n", s32(type));
+        RIO_ASSERT(false);
+        std::memset(value, 0, value_size);
+    }
+
+    return value + value_size;
+}
+
+void ParameterArchiveWriter::callPostWrite_()
+{
+    if (mIsPostWritten)
+        return;
+
+    // Children were added before their parents, so they are also finished first
+    for (std::vector<Node>::const_iterator itr = mIncludedNode.begin(), itr_end = mIncludedNode.end(); itr != itr_end; ++itr)
+    {
+        if (itr->p_list != nullptr)
+            itr->p_list->postWrite_();
+        else
+            itr->p_obj->postWrite_();
+    }
+
+    mIsPostWritten = true;
+}
+
+} }
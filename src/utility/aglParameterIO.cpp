@@ -1,4 +1,7 @@
 //#include <gfx/seadGraphics.h>
+#include <detail/aglFileIOMgr.h>
+#include <misc/rio_MemUtil.h>
+#include <utility/aglParameterArchiveWriter.h>
 #include <utility/aglParameterIO.h>
 
 namespace agl { namespace utl {
@@ -7,17 +10,61 @@ IParameterIO::IParameterIO(const char* type, u32 version)
     : IParameterList()
     , mpDelegate(nullptr)
     , _d4("")
+    , mIsUseApplyPlan(false)
 {
     mType = type;
     mVersion = version;
     setParameterListName_("param_root");
 }
 
-bool IParameterIO::save(const char*, u32) const
+bool IParameterIO::save(const char* file_path, u32 flag) const
 {
     // Deleted from NSMBU
-    // Uses sead::XmlDocument to write this parameter to an XML file
-    return false;
+    // Used sead::XmlDocument to write this parameter to an XML file, this writes the binary archive instead
+
+    RIO_ASSERT(file_path != nullptr);
+
+    detail::FileIOMgr* p_mgr = detail::FileIOMgr::instance();
+    if (p_mgr == nullptr)
+    {
+        RIO_LOG("IParameterIO::save(): FileIOMgr is not created.\n");
+        return false;
+    }
+
+    ParameterArchiveWriter writer(this, mType.c_str(), mVersion);
+    const u32 size = writer.getArchiveSize();
+
+    void* p_buf = rio::MemUtil::alloc(size, 4);
+    if (p_buf == nullptr)
+    {
+        RIO_LOG("IParameterIO::save(): cannot alloc buf\n");
+        RIO_ASSERT(false);
+        return false;
+    }
+
+    bool ret = false;
+
+    if (writer.write(p_buf, size, !(flag & cSaveFlag_BigEndian)) != 0)
+    {
+        detail::FileIOMgr::DialogArg arg;
+        arg.mPath = file_path;
+
+        ret = p_mgr->save(p_buf, size, arg);
+    }
+
+    rio::MemUtil::free(p_buf);
+    return ret;
+}
+
+u32 IParameterIO::calcArchiveSize() const
+{
+    return ParameterArchiveWriter(this, mType.c_str(), mVersion).getArchiveSize();
+}
+
+u32 IParameterIO::writeArchive(void* dst, u32 dst_size, bool is_le) const
+{
+    ParameterArchiveWriter writer(this, mType.c_str(), mVersion);
+    return writer.write(dst, dst_size, is_le);
 }
 
 void IParameterIO::applyResParameterArchive(ResParameterArchive arc)
@@ -29,7 +76,17 @@ void IParameterIO::applyResParameterArchive(ResParameterArchive arc)
         if (mVersion != arc.ref().mTypeVersion)
             callbackInvalidVersion_(arc);
 
-        applyResParameterList(arc.getResParameterList());
+        if (mIsUseApplyPlan)
+        {
+            if (!mApplyPlan.isValid(this, arc))
+                mApplyPlan.build(this, arc);
+
+            mApplyPlan.apply();
+        }
+        else
+        {
+            applyResParameterList(arc.getResParameterList());
+        }
     }
   //sead::Graphics::instance()->unlockDrawContext();
 }
@@ -0,0 +1,205 @@
+#include <utility/aglParameter.h>
+#include <utility/aglParameterLerpPlan.h>
+#include <utility/aglParameterList.h>
+#include <utility/aglParameterObj.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace agl { namespace utl {
+
+ParameterLerpPlan::ParameterLerpPlan()
+    : mpDst(nullptr)
+    , mpA(nullptr)
+    , mpB(nullptr)
+    , mTreeRevision()
+{
+}
+
+void ParameterLerpPlan::build(IParameterList* p_dst, const IParameterList* p_a, const IParameterList* p_b)
+{
+    RIO_ASSERT(p_dst != nullptr);
+    RIO_ASSERT(p_a != nullptr);
+    RIO_ASSERT(p_b != nullptr);
+
+    clear();
+    buildList_(p_dst, p_a, p_b);
+
+    mBufferA.resize(mDst.size());
+    mBufferB.resize(mDst.size());
+
+    mpDst = p_dst;
+    mpA = p_a;
+    mpB = p_b;
+    mTreeRevision[0] = p_dst->getTreeRevision();
+    mTreeRevision[1] = p_a->getTreeRevision();
+    mTreeRevision[2] = p_b->getTreeRevision();
+}
+
+void ParameterLerpPlan::clear()
+{
+    mDst.clear();
+    mSrcA.clear();
+    mSrcB.clear();
+    mBufferA.clear();
+    mBufferB.clear();
+    mCopy.clear();
+    mLerp.clear();
+    mpDst = nullptr;
+    mpA = nullptr;
+    mpB = nullptr;
+}
+
+bool ParameterLerpPlan::isValid(const IParameterList* p_dst, const IParameterList* p_a, const IParameterList* p_b) const
+{
+    return mpDst != nullptr &&
+           mpDst == p_dst &&
+           mpA == p_a &&
+           mpB == p_b &&
+           mTreeRevision[0] == p_dst->getTreeRevision() &&
+           mTreeRevision[1] == p_a->getTreeRevision() &&
+           mTreeRevision[2] == p_b->getTreeRevision();
+}
+
+void ParameterLerpPlan::buildList_(IParameterList* p_dst, const IParameterList* p_a, const IParameterList* p_b)
+{
+    for (OffsetList<IParameterObj>::iterator itr = p_dst->mChildObj.begin(), itr_end = p_dst->mChildObj.end(); itr != itr_end; ++itr)
+    {
+        const IParameterObj* p_obj_a = p_a->findObjByHash_(itr->mNameHash);
+        const IParameterObj* p_obj_b = p_b->findObjByHash_(itr->mNameHash);
+        if (p_obj_a != nullptr && p_obj_b != nullptr)
+            buildObj_(&(*itr), p_obj_a, p_obj_b);
+    }
+
+    for (OffsetList<IParameterList>::iterator itr = p_dst->mChildList.begin(), itr_end = p_dst->mChildList.end(); itr != itr_end; ++itr)
+    {
+        const IParameterList* p_list_a = p_a->findListByHash_(itr->mNameHash);
+        const IParameterList* p_list_b = p_b->findListByHash_(itr->mNameHash);
+        if (p_list_a != nullptr && p_list_b != nullptr)
+            buildList_(&(*itr), p_list_a, p_list_b);
+    }
+}
+
+void ParameterLerpPlan::buildObj_(IParameterObj* p_dst, const IParameterObj* p_a, const IParameterObj* p_b)
+{
+    for (OffsetList<ParameterBase>::iterator itr = p_dst->mChildParameter.begin(), itr_end = p_dst->mChildParameter.end(); itr != itr_end; ++itr)
+    {
+        ParameterBase* p_param = &(*itr);
+        const ParameterBase* p_param_a = p_a->findParameter_(p_param->getNameHash());
+        const ParameterBase* p_param_b = p_b->findParameter_(p_param->getNameHash());
+
+        // Same conditions as ParameterBase::copyLerp()
+        const ParameterBase::ParameterType type = p_param->getParameterType();
+        if (p_param_a == nullptr || p_param_a->getParameterType() != type ||
+            p_param_b == nullptr || p_param_b->getParameterType() != type)
+        {
+            continue;
+        }
+
+        u32 component_num = 0;
+
+        switch (type)
+        {
+        case ParameterBase::cType_bool:
+        case ParameterBase::cType_int:
+        case ParameterBase::cType_string32:
+        case ParameterBase::cType_string64:
+            mCopy.push_back({ p_param, p_param_a });
+            break;
+        case ParameterBase::cType_f32:
+            component_num = 1;
+            break;
+        case ParameterBase::cType_vec2:
+            component_num = 2;
+            break;
+        case ParameterBase::cType_vec3:
+            component_num = 3;
+            break;
+        case ParameterBase::cType_vec4:
+            component_num = 4;
+            break;
+        case ParameterBase::cType_color:
+            // Not the plain expression of the other types, see ParameterBase::copyLerp_()
+            mLerp.push_back({ p_param, p_param_a, p_param_b });
+            break;
+        case ParameterBase::cType_curve1:
+        case ParameterBase::cType_curve2:
+        case ParameterBase::cType_curve3:
+        case ParameterBase::cType_curve4:
+            break;
+        default:
+            RIO_LOG("%d\n", s32(type));
+            RIO_ASSERT(false);
+        }
+
+        f32* dst = static_cast<f32*>(p_param->ptr());
+        const f32* a = static_cast<const f32*>(p_param_a->ptr());
+        const f32* b = static_cast<const f32*>(p_param_b->ptr());
+
+        for (u32 i = 0; i < component_num; i++)
+        {
+            mDst.push_back(dst + i);
+            mSrcA.push_back(a + i);
+            mSrcB.push_back(b + i);
+        }
+    }
+}
+
+void ParameterLerpPlan::apply(f32 t)
+{
+    const u32 num = mDst.size();
+
+    f32* const buffer_a = mBufferA.data();
+    f32* const buffer_b = mBufferB.data();
+
+    {
+        const f32* const* const src_a = mSrcA.data();
+        const f32* const* const src_b = mSrcB.data();
+
+        for (u32 i = 0; i < num; i++)
+        {
+            buffer_a[i] = *src_a[i];
+            buffer_b[i] = *src_b[i];
+        }
+    }
+
+    lerp_(buffer_a, buffer_a, buffer_b, num, t);
+
+    {
+        f32* const* const dst = mDst.data();
+
+        for (u32 i = 0; i < num; i++)
+            *dst[i] = buffer_a[i];
+    }
+
+    for (const Lerp& lerp : mLerp)
+        lerp.p_dst->copyLerp(*lerp.p_a, *lerp.p_b, t);
+
+    for (const Copy& copy : mCopy)
+        copy.p_dst->copyUnsafe(*copy.p_src);
+}
+
+void ParameterLerpPlan::lerp_(f32* dst, const f32* a, const f32* b, u32 num, f32 t)
+{
+    // Same expression as the scalar lerp of ParameterBase::copyLerp_() for f32 and vectors, so that the results are identical
+    const f32 s = 1 - t;
+    u32 i = 0;
+
+#if defined(__SSE2__) || defined(_M_X64)
+    const __m128 vs = _mm_set1_ps(s);
+    const __m128 vt = _mm_set1_ps(t);
+
+    for (; i + 4 <= num; i += 4)
+    {
+        const __m128 va = _mm_loadu_ps(a + i);
+        const __m128 vb = _mm_loadu_ps(b + i);
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_mul_ps(va, vs), _mm_mul_ps(vb, vt)));
+    }
+#endif
+
+    for (; i < num; i++)
+        dst[i] = a[i] * s + b[i] * t;
+}
+
+} }
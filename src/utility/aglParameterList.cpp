@@ -6,6 +6,9 @@ namespace agl { namespace utl {
 
 IParameterList::IParameterList()
     : _70(0)
+    , mpParent(nullptr)
+    , mTreeRevision(0)
+    , mIsCustomApply(false)
 {
     mChildList.initOffset(offsetof(IParameterList, mListNode));
     mChildObj.initOffset(offsetof(IParameterObj, mListNode));
@@ -13,19 +16,55 @@ IParameterList::IParameterList()
     setParameterListName_("");
 }
 
-void IParameterList::setParameterListName_(const char* name)
+void IParameterList::setParameterListName_(const ParameterName& name)
 {
-    mName = name;
-    mNameHash = ParameterBase::calcHash(name);
+    mName = name.getName();
+    mNameHash = name.getHash();
+
+    // The parent's index is keyed by the old hash
+    if (mpParent != nullptr)
+        mpParent->mChildListIndex.invalidate();
+
+    notifyTreeChanged_();
+}
+
+void IParameterList::setCustomApply_()
+{
+    mIsCustomApply = true;
+
+    if (mpParent != nullptr)
+        mpParent->mChildListIndex.invalidate();
 }
 
-void IParameterList::addObj(IParameterObj* child, const char* name)
+void IParameterList::notifyTreeChanged_()
+{
+    for (IParameterList* p_list = this; p_list != nullptr; p_list = p_list->mpParent)
+        p_list->mTreeRevision++;
+}
+
+void IParameterList::addObj(IParameterObj* child, const ParameterName& name)
 {
     RIO_ASSERT(child != nullptr);
-    child->mName = name;
-    child->mNameHash = ParameterBase::calcHash(child->mName.c_str());
+    child->mName = name.getName();
+    child->mNameHash = name.getHash();
+    child->mpParent = this;
 
     mChildObj.pushBack(child);
+    mChildObjIndex.invalidate();
+
+    notifyTreeChanged_();
+}
+
+void IParameterList::addList(IParameterList* child, const ParameterName& name)
+{
+    RIO_ASSERT(child != nullptr);
+    child->setParameterListName_(name);
+    child->mpParent = this;
+
+    mChildList.pushBack(child);
+    mChildListIndex.invalidate();
+
+    notifyTreeChanged_();
 }
 
 void IParameterList::applyResParameterList(ResParameterList list)
@@ -33,6 +72,14 @@ void IParameterList::applyResParameterList(ResParameterList list)
     applyResParameterList_(list);
 }
 
+void IParameterList::lerp(const IParameterList& a, const IParameterList& b, f32 t)
+{
+    if (!mLerpPlan.isValid(this, &a, &b))
+        mLerpPlan.build(this, &a, &b);
+
+    mLerpPlan.apply(t);
+}
+
 void IParameterList::applyResParameterList_(ResParameterList list, bool lerp, f32 t)
 {
     if (!preRead_())
@@ -42,18 +89,14 @@ void IParameterList::applyResParameterList_(ResParameterList list, bool lerp, f3
     {
         ResParameterObj child_obj = list.getResParameterObj(i);
 
-        for (OffsetList<IParameterObj>::iterator itr = mChildObj.begin(), itr_end = mChildObj.end(); itr != itr_end; ++itr)
+        IParameterObj* p_obj = findObj_(child_obj);
+        if (p_obj != nullptr)
         {
-            if (itr->isApply_(child_obj))
-            {
-                if (lerp)
-                    itr->applyResParameterObj_(child_obj, true, t, this);
-
-                else
-                    itr->applyResParameterObj_(child_obj, false, 1.0f, this);
+            if (lerp)
+                p_obj->applyResParameterObj_(child_obj, true, t, this);
 
-                break;
-            }
+            else
+                p_obj->applyResParameterObj_(child_obj, false, 1.0f, this);
         }
     }
 
@@ -61,18 +104,14 @@ void IParameterList::applyResParameterList_(ResParameterList list, bool lerp, f3
     {
         ResParameterList child_list = list.getResParameterList(i);
 
-        for (OffsetList<IParameterList>::iterator itr = mChildList.begin(), itr_end = mChildList.end(); itr != itr_end; ++itr)
+        IParameterList* p_list = findList_(child_list);
+        if (p_list != nullptr)
         {
-            if (itr->isApply_(child_list))
-            {
-                if (lerp)
-                    itr->applyResParameterListB_(child_list, t);
+            if (lerp)
+                p_list->applyResParameterListB_(child_list, t);
 
-                else
-                    itr->applyResParameterList_(child_list);
-
-                break;
-            }
+            else
+                p_list->applyResParameterList_(child_list);
         }
     }
 
@@ -84,4 +123,60 @@ void IParameterList::applyResParameterListB_(ResParameterList list, f32 t)
     applyResParameterList_(list, true, t);
 }
 
+IParameterObj* IParameterList::findObj_(ResParameterObj obj)
+{
+    updateObjIndex_();
+
+    // The first child in the list accepting the name wins, as only custom children may accept names other than their own
+    return mChildObjIndex.findFirst(obj.getParameterObjNameHash(), [obj](const IParameterObj& child) { return child.isApply_(obj); });
+}
+
+IParameterList* IParameterList::findList_(ResParameterList list)
+{
+    updateListIndex_();
+
+    // The first child in the list accepting the name wins, as only custom children may accept names other than their own
+    return mChildListIndex.findFirst(list.getParameterListNameHash(), [list](const IParameterList& child) { return child.isApply_(list); });
+}
+
+IParameterObj* IParameterList::findObjByHash_(u32 name_hash) const
+{
+    updateObjIndex_();
+
+    const ParameterIndex<IParameterObj>::Entry* begin;
+    const ParameterIndex<IParameterObj>::Entry* end;
+    mChildObjIndex.find(name_hash, &begin, &end);
+
+    return begin != end ? begin->ptr : nullptr;
+}
+
+IParameterList* IParameterList::findListByHash_(u32 name_hash) const
+{
+    updateListIndex_();
+
+    const ParameterIndex<IParameterList>::Entry* begin;
+    const ParameterIndex<IParameterList>::Entry* end;
+    mChildListIndex.find(name_hash, &begin, &end);
+
+    return begin != end ? begin->ptr : nullptr;
+}
+
+void IParameterList::updateObjIndex_() const
+{
+    mChildObjIndex.update(
+        mChildObj,
+        [](const IParameterObj& child) { return child.mNameHash; },
+        [](const IParameterObj& child) { return child.mIsCustomApply; }
+    );
+}
+
+void IParameterList::updateListIndex_() const
+{
+    mChildListIndex.update(
+        mChildList,
+        [](const IParameterList& child) { return child.mNameHash; },
+        [](const IParameterList& child) { return child.mIsCustomApply; }
+    );
+}
+
 } }
@@ -7,6 +7,8 @@ namespace agl { namespace utl {
 
 IParameterObj::IParameterObj()
     : mChildHash(0xFFFFFFFF)
+    , mpParent(nullptr)
+    , mIsCustomApply(false)
 {
     mChildParameter.initOffset(offsetof(ParameterBase, mListNode));
 
@@ -17,15 +19,27 @@ void IParameterObj::pushBackListNode(ParameterBase* p_node)
 {
     RIO_ASSERT(p_node != nullptr);
 
-    u32 child_hash[1024];
-    u32 child_num = 0;
+    // mChildHash is the hash of the name hashes of all children before p_node, so only the current last one needs to be added
+    const ParameterBase* p_last = mChildParameter.back();
+    if (p_last == nullptr)
+        mChildHash = HashCRC32::calcHash(nullptr, 0);
+    else
+        mChildHash = HashCRC32::updateHash(mChildHash, &p_last->mHash, sizeof(u32));
 
-    for (OffsetList<ParameterBase>::iterator itr = mChildParameter.begin(), itr_end = mChildParameter.end(); itr != itr_end; ++itr)
-        child_hash[child_num++] = itr->mHash;
+    mChildParameter.pushBack(p_node);
+    mChildParameterIndex.invalidate();
 
-    mChildHash = HashCRC32::calcHash(child_hash, child_num * sizeof(u32));
+    // Objects not added to a list yet are covered by the notification of addObj()
+    if (mpParent != nullptr)
+        mpParent->notifyTreeChanged_();
+}
 
-    mChildParameter.pushBack(p_node);
+void IParameterObj::setCustomApply_()
+{
+    mIsCustomApply = true;
+
+    if (mpParent != nullptr)
+        mpParent->mChildObjIndex.invalidate();
 }
 
 void IParameterObj::applyResParameterObj_(ResParameterObj obj, bool lerp, f32 t, IParameterList* p_list)
@@ -37,39 +51,48 @@ void IParameterObj::applyResParameterObj_(ResParameterObj obj, bool lerp, f32 t,
     {
         ResParameter res = &(*itr_res);
 
-        bool is_apply = false;
-
-        for (OffsetList<ParameterBase>::iterator itr_param = mChildParameter.begin(), itr_param_end = mChildParameter.end(); itr_param != itr_param_end; ++itr_param)
+        ParameterBase* p_param = findParameter_(res.getParameterNameHash());
+        if (p_param != nullptr)
         {
-            if (itr_param->getNameHash() == res.getParameterNameHash())
-            {
-                if (lerp)
-                    itr_param->applyResource(res, t);
+            if (lerp)
+                p_param->applyResource(res, t);
 
-                else
-                    itr_param->applyResource(res);
-
-                is_apply = true;
-                break;
-            }
+            else
+                p_param->applyResource(res);
         }
-
-        if (!is_apply)
+        else
         {
-            if (p_list != nullptr)
-            {
-                p_list->callbackNotAppliable_(this, res);
-
-                // IDK what the following even means
-
-                IParameterList* p_list_next = (IParameterList*)(p_list->mListNode.next()); // ???
-                if (p_list_next != nullptr)
-                    p_list_next->callbackNotAppliable_(this, res);
-            }
+            notifyNotAppliable_(res, p_list);
         }
     }
 
     postRead_();
 }
 
+ParameterBase* IParameterObj::findParameter_(u32 name_hash) const
+{
+    mChildParameterIndex.update(mChildParameter, [](const ParameterBase& child) { return child.getNameHash(); });
+
+    const ParameterIndex<ParameterBase>::Entry* begin;
+    const ParameterIndex<ParameterBase>::Entry* end;
+    mChildParameterIndex.find(name_hash, &begin, &end);
+
+    // Names are only compared by hash, so the first child in the list with it is the one to apply
+    return begin != end ? begin->ptr : nullptr;
+}
+
+void IParameterObj::notifyNotAppliable_(ResParameter res, IParameterList* p_list)
+{
+    if (p_list != nullptr)
+    {
+        p_list->callbackNotAppliable_(this, res);
+
+        // IDK what the following even means
+
+        IParameterList* p_list_next = (IParameterList*)(p_list->mListNode.next()); // ???
+        if (p_list_next != nullptr)
+            p_list_next->callbackNotAppliable_(this, res);
+    }
+}
+
 } }
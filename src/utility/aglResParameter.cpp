@@ -87,6 +87,16 @@ void ResParameterList::modifyEndianList(bool is_le)
         ResParameterObj(&(*itr_obj)).modifyEndianObj(is_le);
 }
 
+u32 ResParameterArchiveData::getVersion()
+{
+    return cVersion;
+}
+
+u32 ResParameterArchiveData::getSignature()
+{
+    return cSignature;
+}
+
 ResParameterArchive::ResParameterArchive(const void* p_data)
     : ResCommon<ResParameterArchiveData>(p_data)
 {